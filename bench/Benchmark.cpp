@@ -0,0 +1,293 @@
+#include "../include/Keybinds.hpp"
+#include <Geode/loader/Log.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <thread>
+
+using namespace geode::prelude;
+using namespace keybinds;
+
+// Counts every allocation in the process. Replacing the global operator new
+// interposes it process-wide on ELF and Mach-O, which is only fine because
+// this is a standalone executable; allocations made by the shim and by the
+// store writer thread are counted too
+static std::atomic<size_t> s_allocations = 0;
+
+void* operator new(size_t size) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+class BenchmarkBind : public Bind {
+protected:
+    int m_index;
+
+public:
+    static BenchmarkBind* create(int index) {
+        auto ret = new BenchmarkBind();
+        ret->m_index = index;
+        ret->autorelease();
+        return ret;
+    }
+    static BenchmarkBind* parse(matjson::Value const& value) {
+        return BenchmarkBind::create(value["index"].as_int());
+    }
+
+    size_t getHash() const override {
+        return std::hash<int>()(m_index);
+    }
+    bool isEqual(Bind* other) const override {
+        if (auto o = typeinfo_cast<BenchmarkBind*>(other)) {
+            return m_index == o->m_index;
+        }
+        return false;
+    }
+    std::string toString() const override {
+        return fmt::format("Benchmark {}", m_index);
+    }
+    DeviceID getDeviceID() const override {
+        return "benchmark"_spr;
+    }
+    matjson::Value save() const override {
+        return matjson::Object {
+            { "index", m_index }
+        };
+    }
+};
+
+template <class F>
+static void measure(const char* name, size_t ops, F&& body) {
+    auto allocations = s_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    allocations = s_allocations.load() - allocations;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    log::info(
+        "{}: {} ops, {:.1f} ns/op, {:.2f} allocations/op",
+        name, ops,
+        static_cast<double>(ns) / ops,
+        static_cast<double>(allocations) / ops
+    );
+}
+
+// what the end of a frame does for the benchmark: autoreleased binds are
+// freed. The main thread queue isn't run, so edits aren't journaled and
+// the only store write is the one BindManager::save makes
+static void endFrame() {
+    CCPoolManager::sharedPoolManager()->pop();
+}
+
+static constexpr size_t BENCHMARK_ACTIONS = 5000;
+static constexpr size_t BENCHMARK_KEYSTROKES = 10000;
+
+static ActionID benchmarkAction(size_t i) {
+    return std::string("benchmark-"_spr) + std::to_string(i);
+}
+
+static BindKey benchmarkKey() {
+    return BindKey::keyboard(KEY_F12, Modifier::Control | Modifier::Shift | Modifier::Alt);
+}
+
+static std::vector<BindableAction> createActions(Category const& category) {
+    std::vector<BindableAction> actions;
+    for (size_t i = 0; i < BENCHMARK_ACTIONS; i++) {
+        actions.push_back(BindableAction(
+            benchmarkAction(i), "Benchmark", "",
+            { Keybind::create(KEY_F12, Modifier::Control | Modifier::Shift | Modifier::Alt) },
+            category, false
+        ));
+    }
+    return actions;
+}
+
+static void setUpMod(std::filesystem::path const& saveDir) {
+    Mod::get()->setSaveDir(saveDir);
+    Mod::get()->setSettingValue("binary-bind-store", true);
+    Mod::get()->setSettingValue("lazy-bind-loading", false);
+}
+
+// the store is written on a background thread, and replaced in one rename
+static bool waitForFile(std::filesystem::path const& path) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!std::filesystem::exists(path)) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return true;
+}
+
+static bool runBenchmarks(std::filesystem::path const& saveDir, std::filesystem::path const& loadDir) {
+    setUpMod(saveDir);
+    auto manager = BindManager::get();
+    Category category = "Benchmark";
+
+    // the binds are created up front so only the registration is measured
+    auto actions = createActions(category);
+    measure("registerBindable", BENCHMARK_ACTIONS, [&] {
+        for (auto& action : actions) {
+            manager->registerBindable(action);
+        }
+    });
+    endFrame();
+
+    // every benchmark action is bound to the same key, so this dispatches
+    // to all of them
+    auto key = benchmarkKey();
+    measure("dispatch (5k actions per key)", BENCHMARK_KEYSTROKES, [&] {
+        for (size_t i = 0; i < BENCHMARK_KEYSTROKES; i++) {
+            PressBindEvent(key, i % 2 == 0).post();
+        }
+    });
+    auto unbound = BindKey::keyboard(KEY_F11, Modifier::Control | Modifier::Shift | Modifier::Alt);
+    measure("dispatch (unbound key)", BENCHMARK_KEYSTROKES, [&] {
+        for (size_t i = 0; i < BENCHMARK_KEYSTROKES; i++) {
+            PressBindEvent(unbound, i % 2 == 0).post();
+        }
+    });
+    endFrame();
+
+    measure("getBindsFor", BENCHMARK_ACTIONS, [&] {
+        for (size_t i = 0; i < BENCHMARK_ACTIONS; i++) {
+            (void)manager->getBindsFor(benchmarkAction(i));
+        }
+    });
+    endFrame();
+
+    manager->attachDevice("benchmark"_spr, &BenchmarkBind::parse);
+    measure("addBindTo (custom device)", BENCHMARK_ACTIONS, [&] {
+        for (size_t i = 0; i < BENCHMARK_ACTIONS; i++) {
+            manager->addBindTo(benchmarkAction(i), BenchmarkBind::create(i));
+        }
+    });
+    endFrame();
+
+    // every action has changed, so this writes all of them, and then waits
+    // for the writer thread to put the store in place
+    auto storePath = saveDir / "binds.bin";
+    bool saved = false;
+    measure("save (5k changed actions)", BENCHMARK_ACTIONS, [&] {
+        manager->save();
+        saved = waitForFile(storePath);
+    });
+    if (!saved) {
+        log::error("The store was never written to {}", storePath.string());
+        return false;
+    }
+    // loaded from a copy, since the writer thread still compacts the journal
+    // in the save directory
+    std::filesystem::copy_file(storePath, loadDir / "binds.bin");
+    std::filesystem::copy_file(saveDir / "binds.journal", loadDir / "binds.journal");
+
+    std::vector<matjson::Value> binds;
+    binds.reserve(BENCHMARK_ACTIONS);
+    measure("saveBind", BENCHMARK_ACTIONS, [&] {
+        for (size_t i = 0; i < BENCHMARK_ACTIONS; i++) {
+            binds.push_back(manager->saveBind(BenchmarkBind::create(i)));
+        }
+    });
+    measure("loadBind", BENCHMARK_ACTIONS, [&] {
+        for (auto& json : binds) {
+            (void)manager->loadBind(json);
+        }
+    });
+    endFrame();
+
+    measure("detachDevice", 1, [&] {
+        manager->detachDevice("benchmark"_spr);
+    });
+    measure("attachDevice", 1, [&] {
+        manager->attachDevice("benchmark"_spr, &BenchmarkBind::parse);
+    });
+    manager->detachDevice("benchmark"_spr);
+    endFrame();
+
+    measure("resetBindsToDefault", BENCHMARK_ACTIONS, [&] {
+        for (size_t i = 0; i < BENCHMARK_ACTIONS; i++) {
+            manager->resetBindsToDefault(benchmarkAction(i));
+        }
+    });
+    endFrame();
+
+    measure("removeBindable", BENCHMARK_ACTIONS, [&] {
+        for (size_t i = 0; i < BENCHMARK_ACTIONS; i++) {
+            manager->removeBindable(benchmarkAction(i));
+        }
+    });
+    manager->removeCategory(category);
+    endFrame();
+    return true;
+}
+
+// Run in a new process, since the store is only read when BindManager is
+// created, like when the game starts
+static bool runLoadBenchmarks(std::filesystem::path const& loadDir) {
+    setUpMod(loadDir);
+    BindManager* manager = nullptr;
+    measure("startup (read store of 5k actions)", 1, [&] {
+        manager = BindManager::get();
+    });
+    manager->attachDevice("benchmark"_spr, &BenchmarkBind::parse);
+
+    auto actions = createActions("Benchmark");
+    measure("registerBindable (stored binds)", BENCHMARK_ACTIONS, [&] {
+        for (auto& action : actions) {
+            manager->registerBindable(action);
+        }
+    });
+    endFrame();
+
+    // each action should have its default key and the bind added to it
+    // before saving
+    for (size_t i = 0; i < BENCHMARK_ACTIONS; i++) {
+        auto binds = manager->getBindsFor(benchmarkAction(i));
+        if (binds.size() != 2) {
+            log::error("{} has {} binds after loading, expected 2", benchmarkAction(i), binds.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string(argv[1]) == "--load") {
+        return runLoadBenchmarks(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // never the game's save directory, the benchmark's actions would be
+    // saved with the player's binds
+    auto dir = std::filesystem::temp_directory_path() /
+        ("custom-keybinds-benchmark-" + std::to_string(std::random_device()()));
+    auto saveDir = dir / "save";
+    auto loadDir = dir / "load";
+    std::filesystem::create_directories(saveDir);
+    std::filesystem::create_directories(loadDir);
+
+    bool ok = runBenchmarks(saveDir, loadDir);
+    if (ok) {
+        auto command = fmt::format("\"{}\" --load \"{}\"", argv[0], loadDir.string());
+        std::fflush(stdout);
+        ok = std::system(command.c_str()) == 0;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
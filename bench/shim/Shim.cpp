@@ -0,0 +1,416 @@
+#include "Shim.hpp"
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace geode::prelude;
+
+// matjson
+
+matjson::Value& matjson::Value::operator[](std::string const& key) {
+    if (std::holds_alternative<std::monostate>(m_value)) {
+        m_value = Object();
+    }
+    if (auto obj = std::get_if<Object>(&m_value)) {
+        return (*obj)[key];
+    }
+    throw std::runtime_error("not an object");
+}
+
+matjson::Value const& matjson::Value::operator[](std::string const& key) const {
+    auto& obj = this->as_object();
+    if (auto found = obj.find(key); found != obj.end()) {
+        return found->second;
+    }
+    throw std::runtime_error("no member named " + key);
+}
+
+bool matjson::Value::contains(std::string const& key) const {
+    auto obj = std::get_if<Object>(&m_value);
+    return obj && obj->contains(key);
+}
+
+static void dumpString(std::string& out, std::string const& str) {
+    out += '"';
+    for (auto c : str) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default: out += c;
+        }
+    }
+    out += '"';
+}
+
+void matjson::Value::dumpTo(std::string& out) const {
+    std::visit([&](auto const& value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+            out += "null";
+        }
+        else if constexpr (std::is_same_v<T, bool>) {
+            out += value ? "true" : "false";
+        }
+        else if constexpr (std::is_same_v<T, double>) {
+            if (value == std::floor(value) && std::abs(value) < 1e15) {
+                out += std::to_string(static_cast<long long>(value));
+            }
+            else {
+                out += std::to_string(value);
+            }
+        }
+        else if constexpr (std::is_same_v<T, std::string>) {
+            dumpString(out, value);
+        }
+        else if constexpr (std::is_same_v<T, Array>) {
+            out += '[';
+            for (size_t i = 0; i < value.size(); i++) {
+                if (i) out += ',';
+                value[i].dumpTo(out);
+            }
+            out += ']';
+        }
+        else {
+            out += '{';
+            bool first = true;
+            for (auto& [key, item] : value) {
+                if (!first) out += ',';
+                first = false;
+                dumpString(out, key);
+                out += ':';
+                item.dumpTo(out);
+            }
+            out += '}';
+        }
+    }, m_value);
+}
+
+std::string matjson::Value::dump(int) const {
+    std::string out;
+    this->dumpTo(out);
+    return out;
+}
+
+namespace {
+    class Parser {
+        std::string_view m_str;
+        size_t m_pos = 0;
+
+        [[noreturn]] void fail() {
+            throw std::runtime_error("invalid json");
+        }
+        void skipSpace() {
+            while (m_pos < m_str.size() && std::isspace(static_cast<unsigned char>(m_str[m_pos]))) {
+                m_pos += 1;
+            }
+        }
+        bool consume(std::string_view token) {
+            this->skipSpace();
+            if (m_str.substr(m_pos).starts_with(token)) {
+                m_pos += token.size();
+                return true;
+            }
+            return false;
+        }
+        std::string parseString() {
+            if (!this->consume("\"")) this->fail();
+            std::string out;
+            while (m_pos < m_str.size() && m_str[m_pos] != '"') {
+                auto c = m_str[m_pos++];
+                if (c == '\\') {
+                    if (m_pos >= m_str.size()) this->fail();
+                    c = m_str[m_pos++];
+                    if (c == 'n') c = '\n';
+                }
+                out += c;
+            }
+            if (m_pos >= m_str.size()) this->fail();
+            m_pos += 1;
+            return out;
+        }
+
+    public:
+        Parser(std::string_view str) : m_str(str) {}
+
+        matjson::Value parseValue() {
+            this->skipSpace();
+            if (m_pos >= m_str.size()) this->fail();
+            if (this->consume("null")) return nullptr;
+            if (this->consume("true")) return true;
+            if (this->consume("false")) return false;
+            if (m_str[m_pos] == '"') return this->parseString();
+            if (this->consume("[")) {
+                matjson::Array arr;
+                if (this->consume("]")) return arr;
+                do {
+                    arr.push_back(this->parseValue());
+                } while (this->consume(","));
+                if (!this->consume("]")) this->fail();
+                return arr;
+            }
+            if (this->consume("{")) {
+                matjson::Object obj;
+                if (this->consume("}")) return obj;
+                do {
+                    this->skipSpace();
+                    auto key = this->parseString();
+                    if (!this->consume(":")) this->fail();
+                    obj[key] = this->parseValue();
+                } while (this->consume(","));
+                if (!this->consume("}")) this->fail();
+                return obj;
+            }
+            auto str = std::string(m_str.substr(m_pos));
+            size_t used = 0;
+            auto num = std::stod(str, &used);
+            m_pos += used;
+            return num;
+        }
+
+        void finish() {
+            this->skipSpace();
+            if (m_pos != m_str.size()) this->fail();
+        }
+    };
+}
+
+matjson::Value matjson::Value::from_str(std::string_view json) {
+    auto parser = Parser(json);
+    auto value = parser.parseValue();
+    parser.finish();
+    return value;
+}
+
+// cocos2d
+
+CCPoolManager* CCPoolManager::sharedPoolManager() {
+    static auto inst = new CCPoolManager();
+    return inst;
+}
+
+void CCPoolManager::addObject(CCObject* object) {
+    m_objects.push_back(object);
+}
+
+void CCPoolManager::pop() {
+    // releasing may autorelease more objects
+    auto objects = std::move(m_objects);
+    m_objects.clear();
+    for (auto obj : objects) {
+        obj->release();
+    }
+}
+
+CCNode::~CCNode() {
+    for (auto child : m_children) {
+        child->release();
+    }
+}
+
+void CCNode::addChild(CCNode* child) {
+    child->retain();
+    m_children.push_back(child);
+}
+
+template <class T>
+static T* createNode() {
+    auto ret = new T();
+    ret->autorelease();
+    return ret;
+}
+
+CCSprite* CCSprite::create(const char*) {
+    return createNode<CCSprite>();
+}
+
+CCSprite* CCSprite::createWithSpriteFrameName(const char*) {
+    return createNode<CCSprite>();
+}
+
+CCScale9Sprite* CCScale9Sprite::create(const char*) {
+    return createNode<CCScale9Sprite>();
+}
+
+CCLabelBMFont* CCLabelBMFont::create(const char* text, const char*) {
+    auto ret = createNode<CCLabelBMFont>();
+    ret->setContentSize({ std::strlen(text) * 10.f, 20.f });
+    return ret;
+}
+
+CCScheduler* CCScheduler::get() {
+    static auto inst = new CCScheduler();
+    return inst;
+}
+
+void CCScheduler::scheduleSelector(SEL_SCHEDULE, CCObject*, float, bool) {}
+
+void CCScheduler::unscheduleSelector(SEL_SCHEDULE, CCObject*) {}
+
+CCKeyboardDispatcher* CCKeyboardDispatcher::get() {
+    static auto inst = new CCKeyboardDispatcher();
+    return inst;
+}
+
+const char* CCKeyboardDispatcher::keyToString(enumKeyCodes key) {
+    static auto const names = [] {
+        std::unordered_map<int, std::string> names;
+        for (int c = KEY_A; c <= KEY_Z; c++) {
+            names[c] = std::string(1, static_cast<char>(c));
+        }
+        for (int c = KEY_Zero; c <= KEY_Nine; c++) {
+            names[c] = std::string(1, static_cast<char>(c));
+        }
+        for (int c = KEY_F1; c <= KEY_F12; c++) {
+            names[c] = "F" + std::to_string(c - KEY_F1 + 1);
+        }
+        names[KEY_Space] = "Space";
+        names[KEY_Enter] = "Enter";
+        names[KEY_Escape] = "Escape";
+        names[KEY_Tab] = "Tab";
+        names[KEY_Backspace] = "Backspace";
+        names[KEY_Delete] = "Delete";
+        names[KEY_Left] = "Left";
+        names[KEY_Right] = "Right";
+        names[KEY_Up] = "Up";
+        names[KEY_Down] = "Down";
+        return names;
+    }();
+    if (auto found = names.find(key); found != names.end()) {
+        return found->second.c_str();
+    }
+    return nullptr;
+}
+
+// geode
+
+void geode::limitNodeSize(CCNode* node, CCSize const& size, float def, float min) {
+    auto contentSize = node->getContentSize();
+    auto scale = def;
+    if (contentSize.width > 0 && contentSize.height > 0) {
+        scale = std::min({ def, size.width / contentSize.width, size.height / contentSize.height });
+    }
+    node->setScale(std::max(scale, min));
+}
+
+Mod* Mod::get() {
+    static auto inst = new Mod();
+    return inst;
+}
+
+Loader* Loader::get() {
+    static auto inst = new Loader();
+    return inst;
+}
+
+void Loader::queueInMainThread(MiniFunction<void()> func) {
+    m_mainThreadQueue.push_back(std::move(func));
+}
+
+void Loader::executeGDThreadQueue() {
+    auto queue = std::move(m_mainThreadQueue);
+    m_mainThreadQueue.clear();
+    for (auto& func : queue) {
+        func();
+    }
+}
+
+// Listeners added or removed while an event is being posted are only
+// added or removed once posting is done, like in Geode
+static std::vector<EventListenerProtocol*> s_listeners;
+static std::vector<EventListenerProtocol*> s_addedListeners;
+static size_t s_postDepth = 0;
+
+EventListenerProtocol::~EventListenerProtocol() = default;
+
+void EventListenerProtocol::enable() {
+    if (s_postDepth) {
+        s_addedListeners.push_back(this);
+    }
+    else {
+        s_listeners.push_back(this);
+    }
+}
+
+void EventListenerProtocol::disable() {
+    std::erase(s_addedListeners, this);
+    if (auto found = std::find(s_listeners.begin(), s_listeners.end(), this); found != s_listeners.end()) {
+        if (s_postDepth) {
+            *found = nullptr;
+        }
+        else {
+            s_listeners.erase(found);
+        }
+    }
+}
+
+ListenerResult Event::post() {
+    s_postDepth += 1;
+    auto result = ListenerResult::Propagate;
+    for (size_t i = 0; i < s_listeners.size(); i++) {
+        if (auto listener = s_listeners[i]) {
+            if (listener->handle(this) == ListenerResult::Stop) {
+                result = ListenerResult::Stop;
+                break;
+            }
+        }
+    }
+    s_postDepth -= 1;
+    if (s_postDepth == 0) {
+        std::erase(s_listeners, nullptr);
+        s_listeners.insert(s_listeners.end(), s_addedListeners.begin(), s_addedListeners.end());
+        s_addedListeners.clear();
+    }
+    return result;
+}
+
+std::vector<std::string> utils::string::split(std::string const& str, std::string const& delim) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    size_t end;
+    while ((end = str.find(delim, start)) != std::string::npos) {
+        parts.push_back(str.substr(start, end - start));
+        start = end + delim.size();
+    }
+    parts.push_back(str.substr(start));
+    return parts;
+}
+
+bool utils::string::contains(std::string const& str, char c) {
+    return str.find(c) != std::string::npos;
+}
+
+std::string utils::string::toLower(std::string const& str) {
+    auto out = str;
+    for (auto& c : out) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return out;
+}
+
+std::string utils::string::trim(std::string const& str) {
+    auto begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    auto end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+Result<ByteVector> utils::file::readBinary(std::filesystem::path const& path) {
+    auto file = std::ifstream(path, std::ios::binary);
+    if (!file) {
+        return Result<ByteVector>("Unable to open file", false);
+    }
+    return ByteVector(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+Result<> utils::file::writeString(std::filesystem::path const& path, std::string const& data) {
+    auto file = std::ofstream(path, std::ios::binary);
+    if (!file || !file.write(data.data(), data.size())) {
+        return Result<>("Unable to write file", false);
+    }
+    return Result<>();
+}
@@ -0,0 +1,611 @@
+#pragma once
+
+// Stand-ins for the parts of Geode, cocos2d and matjson that Keybinds.cpp
+// uses, so BindManager can be built and benchmarked without the game.
+// Everything here follows the real API closely enough to compile the mod's
+// sources unchanged, but only does what a headless run needs: nodes are
+// never drawn, the scheduler never ticks, and saved values live in memory
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#ifndef GEODE_MOD_ID
+    #define GEODE_MOD_ID "geode.custom-keybinds"
+#endif
+
+#define GEODE_CONCAT_IMPL(a, b) a##b
+#define GEODE_CONCAT(a, b) GEODE_CONCAT_IMPL(a, b)
+
+// the benchmark calls what these hooks would, so they're never run
+#define $on_mod(type) [[maybe_unused]] static void GEODE_CONCAT(onMod, type)()
+#define $execute [[maybe_unused]] static void GEODE_CONCAT(execute, __LINE__)()
+
+namespace matjson {
+    class Value;
+    using Object = std::map<std::string, Value>;
+    using Array = std::vector<Value>;
+
+    constexpr int NO_INDENTATION = 0;
+
+    template <class T>
+    struct Serialize;
+
+    class Value {
+        std::variant<std::monostate, bool, double, std::string, Array, Object> m_value;
+
+        template <class T>
+        T const& get(const char* type) const {
+            if (auto value = std::get_if<T>(&m_value)) {
+                return *value;
+            }
+            throw std::runtime_error(std::string("not a ") + type);
+        }
+
+        void dumpTo(std::string& out) const;
+
+    public:
+        Value() : m_value(std::monostate()) {}
+        Value(std::nullptr_t) : m_value(std::monostate()) {}
+        Value(bool value) : m_value(value) {}
+        template <class T>
+            requires std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>)
+        Value(T value) : m_value(static_cast<double>(value)) {}
+        Value(const char* value) : m_value(std::string(value)) {}
+        Value(std::string value) : m_value(std::move(value)) {}
+        Value(Array value) : m_value(std::move(value)) {}
+        Value(Object value) : m_value(std::move(value)) {}
+
+        Value& operator[](std::string const& key);
+        Value const& operator[](std::string const& key) const;
+        bool contains(std::string const& key) const;
+
+        bool as_bool() const { return this->get<bool>("bool"); }
+        int as_int() const { return static_cast<int>(this->get<double>("number")); }
+        double as_double() const { return this->get<double>("number"); }
+        std::string as_string() const { return this->get<std::string>("string"); }
+        Array const& as_array() const { return this->get<Array>("array"); }
+        Object const& as_object() const { return this->get<Object>("object"); }
+
+        template <class T>
+        T as() const {
+            if constexpr (std::is_same_v<T, bool>) return this->as_bool();
+            else if constexpr (std::is_arithmetic_v<T>) return static_cast<T>(this->as_double());
+            else if constexpr (std::is_same_v<T, std::string>) return this->as_string();
+            else if constexpr (std::is_same_v<T, Array>) return this->as_array();
+            else if constexpr (std::is_same_v<T, Object>) return this->as_object();
+            else return *this;
+        }
+
+        std::string dump(int indentation = 4) const;
+        static Value from_str(std::string_view json);
+
+        bool operator==(Value const& other) const { return m_value == other.m_value; }
+        bool operator<(Value const& other) const { return m_value < other.m_value; }
+    };
+}
+
+namespace cocos2d {
+    enum enumKeyCodes {
+        KEY_None = 0, KEY_Backspace = 0x08, KEY_Tab = 0x09, KEY_Enter = 0x0D,
+        KEY_Shift = 0x10, KEY_Control = 0x11, KEY_Alt = 0x12, KEY_Escape = 0x1B,
+        KEY_Space = 0x20, KEY_Left = 0x25, KEY_Up, KEY_Right, KEY_Down,
+        KEY_Delete = 0x2E,
+        KEY_Zero = 0x30, KEY_One, KEY_Two, KEY_Three, KEY_Four, KEY_Five,
+        KEY_Six, KEY_Seven, KEY_Eight, KEY_Nine,
+        KEY_A = 0x41, KEY_B, KEY_C, KEY_D, KEY_E, KEY_F, KEY_G, KEY_H, KEY_I,
+        KEY_J, KEY_K, KEY_L, KEY_M, KEY_N, KEY_O, KEY_P, KEY_Q, KEY_R, KEY_S,
+        KEY_T, KEY_U, KEY_V, KEY_W, KEY_X, KEY_Y, KEY_Z,
+        KEY_LeftWindowsKey = 0x5B, KEY_RightWindowsKey,
+        KEY_Multiply = 0x6A, KEY_Add, KEY_Seperator, KEY_Subtract, KEY_Decimal, KEY_Divide,
+        KEY_F1 = 0x70, KEY_F2, KEY_F3, KEY_F4, KEY_F5, KEY_F6, KEY_F7, KEY_F8,
+        KEY_F9, KEY_F10, KEY_F11, KEY_F12,
+        KEY_LeftShift = 0xA0, KEY_RightShift, KEY_LeftControl, KEY_RightContol,
+        KEY_OEMPlus = 0xBB, KEY_OEMComma, KEY_OEMMinus, KEY_OEMPeriod,
+        CONTROLLER_A = 0x3E9, CONTROLLER_B = 0x3EB, CONTROLLER_Y = 0x3ED,
+        CONTROLLER_X = 0x3EF, CONTROLLER_Start = 0x3F1, CONTROLLER_Back = 0x3F3,
+        CONTROLLER_RB = 0x3F5, CONTROLLER_LB = 0x3F7, CONTROLLER_RT = 0x3F9,
+        CONTROLLER_LT = 0x3FB, CONTROLLER_Up = 0x3FD, CONTROLLER_Down = 0x3FF,
+        CONTROLLER_Left = 0x401, CONTROLLER_Right = 0x403,
+        CONTROLLER_LTHUMBSTICK_UP = 0x405, CONTROLLER_LTHUMBSTICK_DOWN = 0x407,
+        CONTROLLER_LTHUMBSTICK_LEFT = 0x409, CONTROLLER_LTHUMBSTICK_RIGHT = 0x40B,
+        CONTROLLER_RTHUMBSTICK_UP = 0x40D, CONTROLLER_RTHUMBSTICK_DOWN = 0x40F,
+        CONTROLLER_RTHUMBSTICK_LEFT = 0x411, CONTROLLER_RTHUMBSTICK_RIGHT = 0x413,
+        KEY_Unknown = -1,
+    };
+
+    struct CCSize;
+
+    struct CCPoint {
+        float x = 0;
+        float y = 0;
+
+        CCPoint() = default;
+        CCPoint(float x, float y) : x(x), y(y) {}
+        CCPoint(CCSize const& size);
+    };
+
+    struct CCSize {
+        float width = 0;
+        float height = 0;
+
+        CCSize() = default;
+        CCSize(float width, float height) : width(width), height(height) {}
+
+        CCSize operator/(float divisor) const {
+            return { width / divisor, height / divisor };
+        }
+    };
+
+    inline CCPoint::CCPoint(CCSize const& size) : x(size.width), y(size.height) {}
+
+    inline CCPoint ccp(float x, float y) {
+        return { x, y };
+    }
+
+    struct ccColor3B {
+        uint8_t r;
+        uint8_t g;
+        uint8_t b;
+    };
+
+    class CCObject {
+        unsigned int m_retainCount = 1;
+
+    public:
+        CCObject() = default;
+        CCObject(CCObject const&) : CCObject() {}
+        CCObject& operator=(CCObject const&) { return *this; }
+        virtual ~CCObject() = default;
+
+        void retain() {
+            m_retainCount += 1;
+        }
+        void release() {
+            if (--m_retainCount == 0) {
+                delete this;
+            }
+        }
+        CCObject* autorelease();
+        unsigned int retainCount() const {
+            return m_retainCount;
+        }
+    };
+
+    typedef void (CCObject::*SEL_SCHEDULE)(float);
+    #define schedule_selector(_SELECTOR) static_cast<cocos2d::SEL_SCHEDULE>(&_SELECTOR)
+
+    // Released at the end of each frame, which the benchmark does by hand
+    class CCPoolManager {
+        std::vector<CCObject*> m_objects;
+
+    public:
+        static CCPoolManager* sharedPoolManager();
+
+        void addObject(CCObject* object);
+        void pop();
+    };
+
+    inline CCObject* CCObject::autorelease() {
+        CCPoolManager::sharedPoolManager()->addObject(this);
+        return this;
+    }
+
+    class CCNode : public CCObject {
+        std::vector<CCNode*> m_children;
+        CCPoint m_position;
+        CCSize m_contentSize;
+        float m_scale = 1.f;
+        float m_rotation = 0.f;
+
+    public:
+        ~CCNode() override;
+
+        void addChild(CCNode* child);
+        void setPosition(CCPoint const& position) { m_position = position; }
+        CCPoint const& getPosition() const { return m_position; }
+        void setContentSize(CCSize const& size) { m_contentSize = size; }
+        CCSize const& getContentSize() const { return m_contentSize; }
+        CCSize getScaledContentSize() const {
+            return { m_contentSize.width * m_scale, m_contentSize.height * m_scale };
+        }
+        void setScale(float scale) { m_scale = scale; }
+        float getScale() const { return m_scale; }
+        void setRotation(float rotation) { m_rotation = rotation; }
+    };
+
+    class CCNodeRGBA : public CCNode {
+        uint8_t m_opacity = 255;
+        ccColor3B m_color { 255, 255, 255 };
+
+    public:
+        void setOpacity(uint8_t opacity) { m_opacity = opacity; }
+        void setColor(ccColor3B const& color) { m_color = color; }
+    };
+
+    class CCSprite : public CCNodeRGBA {
+    public:
+        static CCSprite* create(const char* file);
+        static CCSprite* createWithSpriteFrameName(const char* frame);
+    };
+
+    class CCScale9Sprite : public CCNodeRGBA {
+    public:
+        static CCScale9Sprite* create(const char* file);
+    };
+
+    class CCLabelBMFont : public CCNodeRGBA {
+    public:
+        static CCLabelBMFont* create(const char* text, const char* font);
+    };
+
+    // Nothing ticks without a game loop, so scheduled selectors never run
+    class CCScheduler {
+    public:
+        static CCScheduler* get();
+
+        void scheduleSelector(SEL_SCHEDULE selector, CCObject* target, float interval, bool paused);
+        void unscheduleSelector(SEL_SCHEDULE selector, CCObject* target);
+    };
+
+    class CCKeyboardDispatcher {
+    public:
+        static CCKeyboardDispatcher* get();
+
+        const char* keyToString(enumKeyCodes key);
+    };
+}
+
+namespace geode {
+    using ByteVector = std::vector<uint8_t>;
+
+    namespace utils {
+        template <class F>
+        using MiniFunction = std::function<F>;
+    }
+
+    template <class T>
+    class Ref final {
+        T* m_obj = nullptr;
+
+    public:
+        Ref() = default;
+        Ref(T* obj) : m_obj(obj) {
+            if (m_obj) m_obj->retain();
+        }
+        Ref(Ref const& other) : Ref(other.m_obj) {}
+        Ref(Ref&& other) noexcept : m_obj(other.m_obj) {
+            other.m_obj = nullptr;
+        }
+        ~Ref() {
+            if (m_obj) m_obj->release();
+        }
+
+        Ref& operator=(T* obj) {
+            if (obj) obj->retain();
+            if (m_obj) m_obj->release();
+            m_obj = obj;
+            return *this;
+        }
+        Ref& operator=(Ref const& other) {
+            return *this = other.m_obj;
+        }
+        Ref& operator=(Ref&& other) noexcept {
+            if (this != &other) {
+                if (m_obj) m_obj->release();
+                m_obj = other.m_obj;
+                other.m_obj = nullptr;
+            }
+            return *this;
+        }
+
+        T* data() const { return m_obj; }
+        operator T*() const { return m_obj; }
+        T* operator->() const { return m_obj; }
+        T& operator*() const { return *m_obj; }
+
+        bool operator==(T* other) const { return m_obj == other; }
+        bool operator==(Ref const& other) const { return m_obj == other.m_obj; }
+    };
+
+    template <class T = void>
+    class Result final {
+        std::optional<T> m_value;
+        std::string m_error;
+
+    public:
+        Result(T value) : m_value(std::move(value)) {}
+        Result(std::string error, bool) : m_error(std::move(error)) {}
+
+        bool isOk() const { return m_value.has_value(); }
+        bool isErr() const { return !m_value.has_value(); }
+        T unwrap() { return std::move(*m_value); }
+        std::string unwrapErr() const { return m_error; }
+    };
+
+    template <>
+    class Result<void> final {
+        std::optional<std::string> m_error;
+
+    public:
+        Result() = default;
+        Result(std::string error, bool) : m_error(std::move(error)) {}
+
+        bool isOk() const { return !m_error.has_value(); }
+        bool isErr() const { return m_error.has_value(); }
+        std::string unwrapErr() const { return m_error.value_or(""); }
+    };
+
+    template <class T>
+    T clamp(T value, T min, T max) {
+        return std::clamp(value, min, max);
+    }
+
+    void limitNodeSize(cocos2d::CCNode* node, cocos2d::CCSize const& size, float def, float min);
+
+    template <class T, class F>
+    T typeinfo_cast(F* obj) {
+        return dynamic_cast<T>(obj);
+    }
+
+    // Saved values and settings are kept in memory, and the save directory
+    // is wherever the benchmark points it
+    class Mod final {
+        std::filesystem::path m_saveDir;
+        matjson::Object m_saved;
+        std::unordered_map<std::string, matjson::Value> m_settings;
+
+    public:
+        static Mod* get();
+
+        std::string getID() const { return GEODE_MOD_ID; }
+
+        std::filesystem::path getSaveDir() const { return m_saveDir; }
+        void setSaveDir(std::filesystem::path const& dir) { m_saveDir = dir; }
+
+        bool hasSavedValue(std::string_view key) const {
+            return m_saved.contains(std::string(key));
+        }
+        template <class T>
+        T getSavedValue(std::string_view key, T const& defaultValue = T()) {
+            if (auto found = m_saved.find(std::string(key)); found != m_saved.end()) {
+                try {
+                    return found->second.template as<T>();
+                }
+                catch(...) {}
+            }
+            m_saved[std::string(key)] = defaultValue;
+            return defaultValue;
+        }
+        template <class T>
+        void setSavedValue(std::string_view key, T const& value) {
+            m_saved[std::string(key)] = value;
+        }
+
+        template <class T>
+        T getSettingValue(std::string_view key) const {
+            if (auto found = m_settings.find(std::string(key)); found != m_settings.end()) {
+                return found->second.template as<T>();
+            }
+            return T();
+        }
+        template <class T>
+        void setSettingValue(std::string_view key, T const& value) {
+            m_settings[std::string(key)] = value;
+        }
+    };
+
+    class Loader final {
+        std::vector<utils::MiniFunction<void()>> m_mainThreadQueue;
+
+    public:
+        static Loader* get();
+
+        void queueInMainThread(utils::MiniFunction<void()> func);
+        // runs what has been queued, like the start of the next frame does
+        void executeGDThreadQueue();
+    };
+
+    enum class ListenerResult {
+        Propagate,
+        Stop,
+    };
+
+    class Event;
+
+    class EventListenerProtocol {
+    public:
+        virtual ~EventListenerProtocol();
+
+        void enable();
+        void disable();
+        virtual ListenerResult handle(Event* event) = 0;
+    };
+
+    class Event {
+    public:
+        virtual ~Event() = default;
+
+        ListenerResult post();
+    };
+
+    template <class T>
+    class EventFilter {
+    public:
+        using Callback = ListenerResult(T*);
+        using Event = T;
+
+        ListenerResult handle(utils::MiniFunction<Callback> fn, T* event) {
+            return fn(event);
+        }
+    };
+
+    template <class Filter>
+    class EventListener final : public EventListenerProtocol {
+        using Callback = typename Filter::Callback;
+        using Event = typename Filter::Event;
+
+        template <class C, class F>
+        struct MemberFn;
+        template <class C, class R, class... Args>
+        struct MemberFn<C, R(Args...)> {
+            using Type = R (C::*)(Args...);
+        };
+
+        utils::MiniFunction<Callback> m_callback;
+        Filter m_filter;
+
+    public:
+        EventListener(Filter filter = Filter()) : m_filter(std::move(filter)) {
+            this->enable();
+        }
+        EventListener(utils::MiniFunction<Callback> fn, Filter filter = Filter())
+          : m_callback(std::move(fn)), m_filter(std::move(filter))
+        {
+            this->enable();
+        }
+        template <class C>
+        EventListener(C* cls, typename MemberFn<C, Callback>::Type fn, Filter filter = Filter())
+          : EventListener(std::bind_front(fn, cls), std::move(filter)) {}
+
+        EventListener(EventListener const& other)
+          : EventListener(other.m_callback, other.m_filter) {}
+        EventListener(EventListener&& other)
+          : EventListener(std::move(other.m_callback), std::move(other.m_filter)) {}
+        ~EventListener() override {
+            this->disable();
+        }
+
+        ListenerResult handle(geode::Event* event) override {
+            if (m_callback) {
+                if (auto typed = dynamic_cast<Event*>(event)) {
+                    if constexpr (std::is_void_v<std::invoke_result_t<Callback*, Event*>>) {
+                        m_filter.handle(m_callback, typed);
+                    }
+                    else {
+                        return m_filter.handle(m_callback, typed);
+                    }
+                }
+            }
+            return ListenerResult::Propagate;
+        }
+
+        void bind(utils::MiniFunction<Callback> fn) {
+            m_callback = std::move(fn);
+        }
+        void setFilter(Filter filter) {
+            m_filter = std::move(filter);
+        }
+        Filter& getFilter() {
+            return m_filter;
+        }
+    };
+
+    namespace utils::ranges {
+        template <class C, class V>
+        bool contains(C const& container, V const& value) {
+            return std::find(container.begin(), container.end(), value) != container.end();
+        }
+
+        template <class C, class V>
+        void remove(C& container, V const& value) {
+            if constexpr (std::is_invocable_r_v<bool, V const&, typename C::value_type const&>) {
+                std::erase_if(container, value);
+            }
+            else {
+                std::erase_if(container, [&](auto const& item) { return item == value; });
+            }
+        }
+    }
+
+    namespace utils::string {
+        std::vector<std::string> split(std::string const& str, std::string const& delim);
+        bool contains(std::string const& str, char c);
+        std::string toLower(std::string const& str);
+        std::string trim(std::string const& str);
+    }
+
+    namespace utils::file {
+        Result<ByteVector> readBinary(std::filesystem::path const& path);
+        Result<> writeString(std::filesystem::path const& path, std::string const& data);
+    }
+}
+
+// Only the `{}` and `{:.Nf}` replacement fields are supported
+namespace fmt {
+    namespace detail {
+        template <class T>
+        void formatArg(std::string& out, std::string_view spec, T const& arg) {
+            if constexpr (std::is_floating_point_v<T>) {
+                if (spec.size() > 2 && spec.front() == '.' && spec.back() == 'f') {
+                    char buf[64];
+                    auto precision = std::stoi(std::string(spec.substr(1, spec.size() - 2)));
+                    std::snprintf(buf, sizeof(buf), "%.*f", precision, static_cast<double>(arg));
+                    out += buf;
+                    return;
+                }
+            }
+            std::ostringstream stream;
+            stream << arg;
+            out += stream.str();
+        }
+    }
+
+    template <class... Args>
+    std::string format(std::string_view format, Args const&... args) {
+        std::string out;
+        auto formatNext = [&](auto const& arg) {
+            auto open = format.find('{');
+            if (open == std::string_view::npos) {
+                return;
+            }
+            auto close = format.find('}', open);
+            out += format.substr(0, open);
+            auto field = format.substr(open + 1, close - open - 1);
+            detail::formatArg(out, field.starts_with(':') ? field.substr(1) : field, arg);
+            format = format.substr(close + 1);
+        };
+        (formatNext(args), ...);
+        out += format;
+        return out;
+    }
+}
+
+namespace geode::log {
+    template <class... Args>
+    void info(std::string_view format, Args const&... args) {
+        std::printf("%s\n", fmt::format(format, args...).c_str());
+    }
+    template <class... Args>
+    void error(std::string_view format, Args const&... args) {
+        std::fprintf(stderr, "%s\n", fmt::format(format, args...).c_str());
+    }
+}
+
+namespace geode::prelude {
+    using namespace ::geode;
+    using namespace ::geode::utils;
+    using namespace ::cocos2d;
+}
+
+// GNU literal operator template (which Geode also uses) so every "x"_spr
+// is a string with static storage
+template <class T, T... Cs>
+const char* operator""_spr() {
+    static std::string const str = std::string(GEODE_MOD_ID "/") + std::string({ Cs... });
+    return str.c_str();
+}
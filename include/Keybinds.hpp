@@ -1,339 +1,938 @@
-#pragma once
-
-#include <Geode/DefaultInclude.hpp>
-#include <Geode/utils/MiniFunction.hpp>
-#include <Geode/utils/cocos.hpp>
-#include <Geode/loader/Mod.hpp>
-#include <Geode/loader/Event.hpp>
-#include <cocos2d.h>
-
-#ifdef GEODE_IS_WINDOWS
-    #ifdef HJFOD_CUSTOM_KEYBINDS_EXPORTING
-        #define CUSTOM_KEYBINDS_DLL __declspec(dllexport)
-    #else
-        #define CUSTOM_KEYBINDS_DLL __declspec(dllimport)
-    #endif
-#else
-    #define CUSTOM_KEYBINDS_DLL
-#endif
-
-struct BindSaveData;
-
-namespace keybinds {
-    class Bind;
-    class BindManager;
-
-    using DeviceID = std::string;
-
-    /**
-     * Base class for implementing bindings for different input devices
-     */
-    class CUSTOM_KEYBINDS_DLL Bind : public cocos2d::CCObject {
-    protected:
-        friend class BindManager;
-
-    public:
-        /**
-         * Get the hash for this bind
-         */
-        virtual size_t getHash() const = 0;
-        /**
-         * Check if this bind is equal to another. By default compares hashes
-         */
-        virtual bool isEqual(Bind* other) const;
-        /**
-         * Get the bind's representation as a human-readable string
-         */
-        virtual std::string toString() const = 0;
-        virtual cocos2d::CCNode* createLabel() const;
-        virtual DeviceID getDeviceID() const = 0;
-        virtual matjson::Value save() const = 0;
-
-        virtual ~Bind() = default;
-
-        cocos2d::CCNodeRGBA* createBindSprite() const;
-    };
-
-    enum class Modifier : unsigned int {
-        None        = 0b0000,
-        Control     = 0b0001,
-        Shift       = 0b0010,
-        Alt         = 0b0100,
-        Command     = 0b1000,
-    #ifdef GEODE_IS_MACOS
-        PlatformControl = Command,
-    #else
-        PlatformControl = Control,
-    #endif
-    };
-    CUSTOM_KEYBINDS_DLL Modifier operator|(Modifier const& a, Modifier const& b);
-    CUSTOM_KEYBINDS_DLL Modifier operator|=(Modifier& a, Modifier const& b);
-    CUSTOM_KEYBINDS_DLL bool operator&(Modifier const& a, Modifier const& b);
-
-    CUSTOM_KEYBINDS_DLL std::string keyToString(cocos2d::enumKeyCodes key);
-    CUSTOM_KEYBINDS_DLL bool keyIsModifier(cocos2d::enumKeyCodes key);
-    CUSTOM_KEYBINDS_DLL bool keyIsController(cocos2d::enumKeyCodes key);
-
-    class CUSTOM_KEYBINDS_DLL Keybind final : public Bind {
-    protected:
-        cocos2d::enumKeyCodes m_key;
-        Modifier m_modifiers;
-
-    public:
-        static Keybind* create(cocos2d::enumKeyCodes key, Modifier modifiers = Modifier::None);
-        static Keybind* parse(matjson::Value const&);
-
-        cocos2d::enumKeyCodes getKey() const;
-        Modifier getModifiers() const;
-
-        size_t getHash() const override;
-        bool isEqual(Bind* other) const override;
-        std::string toString() const override;
-        DeviceID getDeviceID() const override;
-        matjson::Value save() const override;
-    };
-
-    class CUSTOM_KEYBINDS_DLL ControllerBind final : public Bind {
-    protected:
-        cocos2d::enumKeyCodes m_button;
-
-    public:
-        static ControllerBind* create(cocos2d::enumKeyCodes button);
-        static ControllerBind* parse(matjson::Value const&);
-
-        cocos2d::enumKeyCodes getButton() const;
-
-        size_t getHash() const override;
-        bool isEqual(Bind* other) const override;
-        std::string toString() const override;
-        cocos2d::CCNode* createLabel() const override;
-        DeviceID getDeviceID() const override;
-        matjson::Value save() const override;
-    };
-
-    struct CUSTOM_KEYBINDS_DLL BindHash {
-        geode::Ref<Bind> bind;
-        BindHash(Bind* bind);
-        bool operator==(BindHash const& other) const;
-    };
-}
-
-namespace std {
-    template <>
-    struct hash<keybinds::BindHash> {
-        CUSTOM_KEYBINDS_DLL std::size_t operator()(keybinds::BindHash const&) const;
-    };
-}
-
-namespace keybinds {
-    class BindManager;
-    class InvokeBindFilter;
-
-    using ActionID = std::string;
-    class CUSTOM_KEYBINDS_DLL Category final {
-        std::string m_value;
-
-    public:
-        Category() = default;
-        Category(const char* path);
-        Category(std::string const& path);
-        std::vector<std::string> getPath() const;
-        std::optional<Category> getParent() const;
-        bool hasParent(Category const& parent) const;
-        std::string toString() const;
-
-        bool operator==(Category const&) const;
-
-        static constexpr auto PLAY { "Play" };
-        static constexpr auto PLAY_PAUSE { "Play/Pause" };
-        static constexpr auto EDITOR { "Editor" };
-        static constexpr auto GLOBAL { "Global" };
-        static constexpr auto EDITOR_UI { "Editor/UI" };
-        static constexpr auto EDITOR_MODIFY { "Editor/Modify" };
-        static constexpr auto EDITOR_MOVE { "Editor/Move" };
-    };
-
-    class CUSTOM_KEYBINDS_DLL BindableAction {
-    protected:
-        ActionID m_id;
-        std::string m_name;
-        std::string m_description;
-        geode::Mod* m_owner;
-        std::vector<geode::Ref<Bind>> m_defaults;
-        Category m_category;
-        bool m_repeatable;
-
-    public:
-        ActionID getID() const;
-        std::string getName() const;
-        std::string getDescription() const;
-        geode::Mod* getMod() const;
-        std::vector<geode::Ref<Bind>> getDefaults() const;
-        Category getCategory() const;
-        bool isRepeatable() const;
-
-        BindableAction() = default;
-        BindableAction(
-            ActionID const& id,
-            std::string const& name,
-            std::string const& description = "",
-            std::vector<geode::Ref<Bind>> const& defaults = {},
-            Category const& category = Category(),
-            bool repeatable = true,
-            geode::Mod* owner = geode::Mod::get()
-        );
-    };
-
-    class CUSTOM_KEYBINDS_DLL InvokeBindEvent : public geode::Event {
-    protected:
-        ActionID m_id;
-        bool m_down;
-
-        friend class BindManager;
-        friend class InvokeBindFilter;
-
-    public:
-        InvokeBindEvent(ActionID const& id, bool down);
-        ActionID getID() const;
-        bool isDown() const;
-    };
-
-    class CUSTOM_KEYBINDS_DLL InvokeBindFilter : public geode::EventFilter<InvokeBindEvent> {
-    protected:
-        cocos2d::CCNode* m_target;
-        ActionID m_id;
-
-    public:
-        using Callback = geode::ListenerResult(InvokeBindEvent*);
-
-        geode::ListenerResult handle(geode::utils::MiniFunction<Callback> fn, InvokeBindEvent* event);
-        InvokeBindFilter(cocos2d::CCNode* target, ActionID const& id);
-    };
-
-    class CUSTOM_KEYBINDS_DLL PressBindEvent : public geode::Event {
-    protected:
-        Bind* m_bind;
-        bool m_down;
-
-    public:
-        PressBindEvent(Bind* bind, bool down);
-        Bind* getBind() const;
-        bool isDown() const;
-    };
-
-    class CUSTOM_KEYBINDS_DLL PressBindFilter : public geode::EventFilter<PressBindEvent> {
-    public:
-        using Callback = geode::ListenerResult(PressBindEvent*);
-
-        geode::ListenerResult handle(geode::utils::MiniFunction<Callback> fn, PressBindEvent* event);
-        PressBindFilter();
-    };
-
-    class CUSTOM_KEYBINDS_DLL DeviceEvent : public geode::Event {
-    protected:
-        DeviceID m_id;
-        bool m_attached;
-
-    public:
-        DeviceEvent(DeviceID const& id, bool attached);
-        DeviceID getID() const;
-        bool wasAttached() const;
-        bool wasDetached() const;
-    };
-
-    class CUSTOM_KEYBINDS_DLL DeviceFilter : public geode::EventFilter<DeviceEvent> {
-    protected:
-        std::optional<DeviceID> m_id;
-
-    public:
-        using Callback = void(DeviceEvent*);
-
-        geode::ListenerResult handle(geode::utils::MiniFunction<Callback> fn, DeviceEvent* event);
-        DeviceFilter(std::optional<DeviceID> id = std::nullopt);
-    };
-
-    struct CUSTOM_KEYBINDS_DLL RepeatOptions {
-        bool enabled = true;
-        size_t rate = 50;
-        size_t delay = 500;
-    };
-
-    using BindParser = std::function<Bind*(matjson::Value const&)>;
-
-    class CUSTOM_KEYBINDS_DLL BindManager : public cocos2d::CCObject {
-    // has to inherit from CCObject for scheduler
-    public:
-        using DevicelessActions = std::unordered_map<ActionID, std::set<matjson::Value>>;
-
-    protected:
-        struct ActionData {
-            BindableAction definition;
-            RepeatOptions repeat;
-        };
-
-        std::unordered_map<BindHash, std::vector<ActionID>> m_binds;
-        std::unordered_map<DeviceID, DevicelessActions> m_devicelessBinds;
-        std::unordered_map<DeviceID, BindParser> m_devices;
-        std::vector<std::pair<ActionID, ActionData>> m_actions;
-        std::vector<Category> m_categories;
-        geode::EventListener<PressBindFilter> m_listener =
-            geode::EventListener<PressBindFilter>(this, &BindManager::onDispatch);
-        std::vector<std::pair<ActionID, float>> m_repeating;
-        std::unordered_set<ActionID> m_held;
-
-        BindManager();
-
-        geode::ListenerResult onDispatch(PressBindEvent* event);
-        void onRepeat(float dt);
-        void repeat(ActionID const& action);
-        void unrepeat(ActionID const& action);
-
-        bool loadActionBinds(ActionID const& action);
-        void saveActionBinds(ActionID const& action);
-
-        friend class InvokeBindFilter;
-        friend struct matjson::Serialize<BindSaveData>;
-
-    public:
-        static BindManager* get();
-        void save();
-
-        void attachDevice(DeviceID const& device, BindParser parser);
-        void detachDevice(DeviceID const& device);
-
-        matjson::Value saveBind(Bind* bind) const;
-        Bind* loadBind(matjson::Value const& json) const;
-
-        bool registerBindable(BindableAction const& action, ActionID const& after = "");
-        void removeBindable(ActionID const& action);
-        std::optional<BindableAction> getBindable(ActionID const& action) const;
-        std::vector<BindableAction> getAllBindables() const;
-        std::vector<BindableAction> getBindablesIn(Category const& category, bool sub = false) const;
-        std::vector<BindableAction> getBindablesFor(Bind* bind) const;
-        std::vector<Category> getAllCategories() const;
-        /**
-         * Add a new bindable category. If the category is a subcategory (its
-         * ID has a slash, like "Editor/Modify"), then all its parent
-         * categories are inserted aswell, and the subcategory is added after
-         * its parent's last subcategory
-         * @param category The category to add. Specify a subcategory by
-         * including a slash in the name (like "Editor/Modify")
-         */
-        void addCategory(Category const& category);
-        /**
-         * @note Also removes all the bindables in this category
-         */
-        void removeCategory(Category const& category);
-
-        void addBindTo(ActionID const& action, Bind* bind);
-        void removeBindFrom(ActionID const& action, Bind* bind);
-        void removeAllBindsFrom(ActionID const& action);
-        void resetBindsToDefault(ActionID const& action);
-        bool hasDefaultBinds(ActionID const& action) const;
-        std::vector<geode::Ref<Bind>> getBindsFor(ActionID const& action) const;
-
-        std::optional<RepeatOptions> getRepeatOptionsFor(ActionID const& action);
-        void setRepeatOptionsFor(ActionID const& action, RepeatOptions const& options);
-        void stopAllRepeats();
-    };
-}
+#pragma once
+
+#include <Geode/DefaultInclude.hpp>
+#include <Geode/utils/MiniFunction.hpp>
+#include <Geode/utils/cocos.hpp>
+#include <Geode/loader/Mod.hpp>
+#include <Geode/loader/Event.hpp>
+#include <cocos2d.h>
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+#ifdef GEODE_IS_WINDOWS
+    #ifdef HJFOD_CUSTOM_KEYBINDS_EXPORTING
+        #define CUSTOM_KEYBINDS_DLL __declspec(dllexport)
+    #else
+        #define CUSTOM_KEYBINDS_DLL __declspec(dllimport)
+    #endif
+#else
+    #define CUSTOM_KEYBINDS_DLL
+#endif
+
+struct BindSaveData;
+
+namespace keybinds {
+    class Bind;
+    class BindManager;
+
+    using DeviceID = std::string;
+
+    /**
+     * Base class for implementing bindings for different input devices
+     */
+    class CUSTOM_KEYBINDS_DLL Bind : public cocos2d::CCObject {
+    protected:
+        friend class BindManager;
+
+    public:
+        /**
+         * Get the hash for this bind
+         */
+        virtual size_t getHash() const = 0;
+        /**
+         * Check if this bind is equal to another. By default compares hashes
+         */
+        virtual bool isEqual(Bind* other) const;
+        /**
+         * Get the bind's representation as a human-readable string
+         */
+        virtual std::string toString() const = 0;
+        virtual cocos2d::CCNode* createLabel() const;
+        virtual DeviceID getDeviceID() const = 0;
+        virtual matjson::Value save() const = 0;
+
+        virtual ~Bind() = default;
+
+        cocos2d::CCNodeRGBA* createBindSprite() const;
+    };
+
+    enum class Modifier : unsigned int {
+        None        = 0b0000,
+        Control     = 0b0001,
+        Shift       = 0b0010,
+        Alt         = 0b0100,
+        Command     = 0b1000,
+    #ifdef GEODE_IS_MACOS
+        PlatformControl = Command,
+    #else
+        PlatformControl = Control,
+    #endif
+    };
+    constexpr Modifier operator|(Modifier const& a, Modifier const& b) {
+        return static_cast<Modifier>(static_cast<unsigned int>(a) | static_cast<unsigned int>(b));
+    }
+    CUSTOM_KEYBINDS_DLL Modifier operator|=(Modifier& a, Modifier const& b);
+    CUSTOM_KEYBINDS_DLL bool operator&(Modifier const& a, Modifier const& b);
+
+    CUSTOM_KEYBINDS_DLL std::string keyToString(cocos2d::enumKeyCodes key);
+    CUSTOM_KEYBINDS_DLL bool keyIsModifier(cocos2d::enumKeyCodes key);
+    CUSTOM_KEYBINDS_DLL bool keyIsController(cocos2d::enumKeyCodes key);
+
+    /**
+     * A packed value identifying a bind: the ordinal of its input device, its
+     * key or button code, and the modifiers held with it. Unlike Bind, this
+     * is a plain value, so input hooks can build one on the stack for every
+     * keystroke and look it up without allocating anything. For devices
+     * other than the built-in ones, the code is an index BindManager assigns
+     * to each distinct bind
+     */
+    class BindKey final {
+    protected:
+        uint64_t m_value = 0;
+
+    public:
+        /**
+         * Device ordinals of the built-in devices. Other devices get theirs
+         * from BindManager::getDeviceOrdinal. An ordinal of 0 means the key
+         * is empty
+         */
+        static constexpr uint16_t KEYBOARD = 1;
+        static constexpr uint16_t CONTROLLER = 2;
+
+        constexpr BindKey() = default;
+        constexpr BindKey(uint16_t device, uint32_t code, Modifier modifiers = Modifier::None)
+          : m_value(
+                static_cast<uint64_t>(device) << 48 |
+                static_cast<uint64_t>(static_cast<uint16_t>(modifiers)) << 32 |
+                code
+            ) {}
+
+        static constexpr BindKey keyboard(cocos2d::enumKeyCodes key, Modifier modifiers = Modifier::None) {
+            return BindKey(KEYBOARD, static_cast<uint32_t>(key), modifiers);
+        }
+        static constexpr BindKey controller(cocos2d::enumKeyCodes button) {
+            return BindKey(CONTROLLER, static_cast<uint32_t>(button));
+        }
+
+        constexpr uint16_t getDevice() const {
+            return static_cast<uint16_t>(m_value >> 48);
+        }
+        constexpr uint32_t getCode() const {
+            return static_cast<uint32_t>(m_value);
+        }
+        constexpr Modifier getModifiers() const {
+            return static_cast<Modifier>((m_value >> 32) & 0xffff);
+        }
+        constexpr uint64_t getValue() const {
+            return m_value;
+        }
+
+        constexpr explicit operator bool() const {
+            return m_value != 0;
+        }
+        constexpr bool operator==(BindKey const&) const = default;
+    };
+
+    /**
+     * Parse a keyboard or controller bind written the way Keybind and
+     * ControllerBind show them, like "Ctrl + Z" or "Shift+F5". Case and
+     * spaces around the pluses don't matter
+     * @returns The key, or nullopt if the expression isn't a valid bind
+     */
+    CUSTOM_KEYBINDS_DLL std::optional<BindKey> parseBindKey(std::string_view expr);
+
+    class CUSTOM_KEYBINDS_DLL Keybind final : public Bind {
+    protected:
+        cocos2d::enumKeyCodes m_key;
+        Modifier m_modifiers;
+
+    public:
+        static Keybind* create(cocos2d::enumKeyCodes key, Modifier modifiers = Modifier::None);
+        static Keybind* parse(matjson::Value const&);
+
+        cocos2d::enumKeyCodes getKey() const;
+        Modifier getModifiers() const;
+
+        size_t getHash() const override;
+        bool isEqual(Bind* other) const override;
+        std::string toString() const override;
+        DeviceID getDeviceID() const override;
+        matjson::Value save() const override;
+    };
+
+    class CUSTOM_KEYBINDS_DLL ControllerBind final : public Bind {
+    protected:
+        cocos2d::enumKeyCodes m_button;
+
+    public:
+        static ControllerBind* create(cocos2d::enumKeyCodes button);
+        static ControllerBind* parse(matjson::Value const&);
+
+        cocos2d::enumKeyCodes getButton() const;
+
+        size_t getHash() const override;
+        bool isEqual(Bind* other) const override;
+        std::string toString() const override;
+        cocos2d::CCNode* createLabel() const override;
+        DeviceID getDeviceID() const override;
+        matjson::Value save() const override;
+    };
+
+    /**
+     * @deprecated BindManager keys binds by BindKey now; this is only kept
+     * for mods that still use it in their own containers
+     */
+    struct CUSTOM_KEYBINDS_DLL BindHash {
+        geode::Ref<Bind> bind;
+        /**
+         * Packed key of the bind, if it's from a built-in device. A BindHash
+         * constructed from only a key can be used for lookups, but never has
+         * a bind object
+         */
+        BindKey key;
+        BindHash(Bind* bind);
+        BindHash(BindKey key);
+        bool operator==(BindHash const& other) const;
+    };
+}
+
+namespace std {
+    template <>
+    struct hash<keybinds::BindKey> {
+        std::size_t operator()(keybinds::BindKey const& key) const noexcept {
+            // the device and modifiers live in the high bits, so mix them
+            // down for 32-bit size_t and power-of-two bucket counts
+            auto x = key.getValue();
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33;
+            return static_cast<std::size_t>(x);
+        }
+    };
+    template <>
+    struct hash<keybinds::BindHash> {
+        CUSTOM_KEYBINDS_DLL std::size_t operator()(keybinds::BindHash const&) const;
+    };
+}
+
+namespace keybinds {
+    using ActionID = std::string;
+
+    /**
+     * An interned integer handle for an action ID. A handle stays the same
+     * for the rest of the session, even if its action is removed, and
+     * comparing handles is much cheaper than comparing IDs
+     */
+    class ActionHandle final {
+    protected:
+        uint32_t m_value = UINT32_MAX;
+
+    public:
+        constexpr ActionHandle() = default;
+        constexpr explicit ActionHandle(uint32_t value) : m_value(value) {}
+
+        constexpr uint32_t getValue() const {
+            return m_value;
+        }
+
+        constexpr explicit operator bool() const {
+            return m_value != UINT32_MAX;
+        }
+        constexpr bool operator==(ActionHandle const&) const = default;
+    };
+}
+
+namespace std {
+    template <>
+    struct hash<keybinds::ActionHandle> {
+        std::size_t operator()(keybinds::ActionHandle const& handle) const noexcept {
+            return handle.getValue();
+        }
+    };
+}
+
+namespace keybinds {
+    class BindManager;
+    class InvokeBindFilter;
+
+    using Timestamp = std::chrono::steady_clock::time_point;
+
+    /**
+     * A log-linear histogram of latencies in nanoseconds, in the style of
+     * HdrHistogram. Values below SUB_BUCKETS are exact, and larger values
+     * are kept to within 1/SUB_BUCKETS of what was recorded
+     */
+    class CUSTOM_KEYBINDS_DLL LatencyHistogram final {
+    public:
+        // each power of two is split into this many buckets
+        static constexpr size_t SUB_BUCKETS = 32;
+        // values above 2^41 ns (about 36 minutes) are clamped to that
+        static constexpr size_t MAX_EXPONENT = 41;
+        static constexpr size_t BUCKETS = (MAX_EXPONENT - 4) * SUB_BUCKETS;
+
+    protected:
+        std::array<uint32_t, BUCKETS> m_counts {};
+        uint64_t m_count = 0;
+        uint64_t m_total = 0;
+        uint64_t m_min = UINT64_MAX;
+        uint64_t m_max = 0;
+
+        static size_t bucketOf(uint64_t ns);
+        static uint64_t highestValueIn(size_t bucket);
+
+    public:
+        void record(std::chrono::nanoseconds latency);
+        void reset();
+
+        uint64_t getCount() const;
+        std::chrono::nanoseconds getMin() const;
+        std::chrono::nanoseconds getMax() const;
+        std::chrono::nanoseconds getMean() const;
+        /**
+         * Get the latency that the given percentage (0-100) of the recorded
+         * latencies are at or below
+         */
+        std::chrono::nanoseconds getPercentile(double percentile) const;
+    };
+
+    enum class LatencyStage {
+        // from the key event reaching the game until BindManager gets it
+        Input,
+        // finding the actions bound to the pressed key
+        Lookup,
+        // updating the held and repeating state of an action
+        Repeat,
+        // calling the listeners of an action
+        Listeners,
+    };
+    static constexpr size_t LATENCY_STAGE_COUNT = 4;
+
+    class CUSTOM_KEYBINDS_DLL Category final {
+        std::string m_value;
+
+    public:
+        Category() = default;
+        Category(const char* path);
+        Category(std::string const& path);
+        std::vector<std::string> getPath() const;
+        std::optional<Category> getParent() const;
+        bool hasParent(Category const& parent) const;
+        std::string toString() const;
+
+        bool operator==(Category const&) const;
+
+        static constexpr auto PLAY { "Play" };
+        static constexpr auto PLAY_PAUSE { "Play/Pause" };
+        static constexpr auto EDITOR { "Editor" };
+        static constexpr auto GLOBAL { "Global" };
+        static constexpr auto EDITOR_UI { "Editor/UI" };
+        static constexpr auto EDITOR_MODIFY { "Editor/Modify" };
+        static constexpr auto EDITOR_MOVE { "Editor/Move" };
+    };
+
+    /**
+     * A bindable action whose strings and default binds are all known at
+     * compile time, so tables of them can be constexpr. Registering one with
+     * BindManager::registerBindables binds its defaults without creating any
+     * Bind objects
+     */
+    struct BindableDescriptor final {
+        static constexpr size_t MAX_DEFAULTS = 5;
+
+        const char* id;
+        const char* name;
+        const char* description;
+        // unused slots are left as empty keys
+        std::array<BindKey, MAX_DEFAULTS> defaults;
+        const char* category;
+        bool repeatable;
+    };
+
+    class CUSTOM_KEYBINDS_DLL BindableAction {
+    protected:
+        ActionID m_id;
+        std::string m_name;
+        std::string m_description;
+        geode::Mod* m_owner;
+        std::vector<geode::Ref<Bind>> m_defaults;
+        Category m_category;
+        bool m_repeatable;
+        // defaults given as keys. Their Bind objects are only created by
+        // getDefaults
+        std::vector<BindKey> m_defaultKeys;
+
+        friend class BindManager;
+
+    public:
+        ActionID getID() const;
+        std::string getName() const;
+        std::string getDescription() const;
+        geode::Mod* getMod() const;
+        std::vector<geode::Ref<Bind>> getDefaults() const;
+        Category getCategory() const;
+        bool isRepeatable() const;
+
+        BindableAction() = default;
+        BindableAction(
+            ActionID const& id,
+            std::string const& name,
+            std::string const& description = "",
+            std::vector<geode::Ref<Bind>> const& defaults = {},
+            Category const& category = Category(),
+            bool repeatable = true,
+            geode::Mod* owner = geode::Mod::get()
+        );
+        BindableAction(
+            BindableDescriptor const& descriptor,
+            geode::Mod* owner = geode::Mod::get()
+        );
+    };
+
+    class CUSTOM_KEYBINDS_DLL InvokeBindEvent : public geode::Event {
+    protected:
+        ActionID m_id;
+        ActionHandle m_handle;
+        bool m_down;
+        // set on events BindManager has already given to its ActionListeners
+        bool m_direct = false;
+        std::optional<Timestamp> m_timestamp;
+
+        friend class BindManager;
+        friend class InvokeBindFilter;
+
+    public:
+        InvokeBindEvent(ActionID const& id, bool down);
+        /**
+         * Invoke an action by its handle. This doesn't copy the action's ID,
+         * so prefer it if you're invoking actions often
+         */
+        InvokeBindEvent(ActionHandle handle, bool down);
+        ActionID getID() const;
+        ActionHandle getHandle() const;
+        bool isDown() const;
+        /**
+         * Get when the input that caused this event reached the game. Only
+         * set while BindManager is profiling
+         */
+        std::optional<Timestamp> getTimestamp() const;
+        void setTimestamp(std::optional<Timestamp> timestamp);
+    };
+
+    class CUSTOM_KEYBINDS_DLL InvokeBindFilter : public geode::EventFilter<InvokeBindEvent> {
+    protected:
+        cocos2d::CCNode* m_target;
+        ActionID m_id;
+        ActionHandle m_handle;
+
+    public:
+        using Callback = geode::ListenerResult(InvokeBindEvent*);
+
+        geode::ListenerResult handle(geode::utils::MiniFunction<Callback> fn, InvokeBindEvent* event);
+        InvokeBindFilter(cocos2d::CCNode* target, ActionID const& id);
+        InvokeBindFilter(cocos2d::CCNode* target, ActionHandle handle);
+        InvokeBindFilter(InvokeBindFilter const& other);
+        InvokeBindFilter& operator=(InvokeBindFilter const& other);
+        ~InvokeBindFilter();
+    };
+
+    /**
+     * A listener that BindManager calls directly when its action is invoked.
+     * Unlike InvokeBindFilter, this doesn't go through Geode's event system,
+     * so invoking an action only costs as much as that action's listeners.
+     * The listener is active for as long as the object is alive, so keep a
+     * Ref to it, for example in the fields of a modified layer
+     */
+    class CUSTOM_KEYBINDS_DLL ActionListener : public cocos2d::CCObject {
+    public:
+        using Callback = geode::ListenerResult(InvokeBindEvent*);
+
+    protected:
+        ActionHandle m_action;
+        geode::utils::MiniFunction<Callback> m_callback;
+
+        ActionListener(ActionHandle action, geode::utils::MiniFunction<Callback> callback);
+
+        friend class BindManager;
+
+    public:
+        static ActionListener* create(ActionHandle action, geode::utils::MiniFunction<Callback> callback);
+        static ActionListener* create(ActionID const& action, geode::utils::MiniFunction<Callback> callback);
+        ~ActionListener() override;
+
+        ActionHandle getAction() const;
+    };
+
+    class CUSTOM_KEYBINDS_DLL PressBindEvent : public geode::Event {
+    protected:
+        mutable Bind* m_bind;
+        BindKey m_key;
+        bool m_down;
+        std::optional<Timestamp> m_timestamp;
+
+    public:
+        PressBindEvent(Bind* bind, bool down);
+        /**
+         * Post a press without creating a Bind. Use this for binds from the
+         * built-in devices in hot paths like input hooks
+         */
+        PressBindEvent(BindKey key, bool down);
+        /**
+         * Get the pressed bind. If the event was created from a BindKey, the
+         * bind is only created the first time this is called
+         */
+        Bind* getBind() const;
+        /**
+         * Get the packed key of the pressed bind. Empty if the bind is not
+         * from a built-in device
+         */
+        BindKey getKey() const;
+        bool isDown() const;
+        /**
+         * Get when the input reached the game. Input hooks should set this
+         * if BindManager::isProfiling is on, so the latency of the actions
+         * it invokes can be measured
+         */
+        std::optional<Timestamp> getTimestamp() const;
+        void setTimestamp(std::optional<Timestamp> timestamp);
+    };
+
+    class CUSTOM_KEYBINDS_DLL PressBindFilter : public geode::EventFilter<PressBindEvent> {
+    public:
+        using Callback = geode::ListenerResult(PressBindEvent*);
+
+        geode::ListenerResult handle(geode::utils::MiniFunction<Callback> fn, PressBindEvent* event);
+        PressBindFilter();
+    };
+
+    class CUSTOM_KEYBINDS_DLL DeviceEvent : public geode::Event {
+    protected:
+        DeviceID m_id;
+        bool m_attached;
+
+    public:
+        DeviceEvent(DeviceID const& id, bool attached);
+        DeviceID getID() const;
+        bool wasAttached() const;
+        bool wasDetached() const;
+    };
+
+    class CUSTOM_KEYBINDS_DLL DeviceFilter : public geode::EventFilter<DeviceEvent> {
+    protected:
+        std::optional<DeviceID> m_id;
+
+    public:
+        using Callback = void(DeviceEvent*);
+
+        geode::ListenerResult handle(geode::utils::MiniFunction<Callback> fn, DeviceEvent* event);
+        DeviceFilter(std::optional<DeviceID> id = std::nullopt);
+    };
+
+    struct CUSTOM_KEYBINDS_DLL RepeatOptions {
+        bool enabled = true;
+        size_t rate = 50;
+        size_t delay = 500;
+    };
+
+    using BindParser = std::function<Bind*(matjson::Value const&)>;
+
+    class CUSTOM_KEYBINDS_DLL BindManager : public cocos2d::CCObject {
+    // has to inherit from CCObject for scheduler
+    public:
+        using DevicelessActions = std::unordered_map<ActionID, std::set<matjson::Value>>;
+
+    protected:
+        struct ActionData {
+            ActionID id;
+            BindableAction definition;
+            RepeatOptions repeat;
+            // the action's binds in the order they were added; the reverse
+            // of m_binds
+            std::vector<BindKey> binds;
+            // listeners are set to null if they're removed during dispatch
+            std::vector<ActionListener*> listeners;
+            // number of live InvokeBindFilters for this action; the Geode
+            // event is only posted if there are any
+            size_t legacyFilters = 0;
+            // bumped whenever the action stops or restarts repeating, so its
+            // old timers in m_repeatQueue can be told apart and skipped
+            uint32_t repeatGeneration = 0;
+            // created the first time the action is invoked while profiling
+            std::unique_ptr<LatencyHistogram> latency;
+            bool repeating = false;
+            // whether the binds or repeat options have changed since the
+            // action was last saved or loaded
+            bool dirty = false;
+            // whether the action is waiting to be written to the journal
+            bool journalPending = false;
+            bool registered = false;
+            // false while loading the action's binds is deferred in lazy
+            // mode, until something needs them
+            bool loaded = true;
+        };
+        struct RepeatTimer {
+            double deadline;
+            ActionHandle action;
+            uint32_t generation;
+
+            bool operator>(RepeatTimer const& other) const;
+        };
+        // an action's entry in the binary bind store
+        struct StoredAction {
+            // binds from the built-in devices
+            std::vector<BindKey> keys;
+            // binds from other devices, in the format they're saved as JSON
+            std::vector<matjson::Value> custom;
+            std::optional<RepeatOptions> repeat;
+        };
+        struct InternedBinds {
+            std::vector<geode::Ref<Bind>> binds;
+            std::unordered_multimap<size_t, uint32_t> byHash;
+        };
+
+        std::unordered_map<BindKey, std::vector<ActionHandle>> m_binds;
+        std::unordered_map<DeviceID, DevicelessActions> m_devicelessBinds;
+        std::unordered_map<DeviceID, BindParser> m_devices;
+        std::unordered_map<DeviceID, uint16_t> m_deviceOrdinals;
+        // binds from devices other than the keyboard and controller, indexed
+        // by device ordinal and then by the code in their BindKey
+        std::vector<InternedBinds> m_internedBinds;
+        // indexed by ActionHandle. Every interned ID has a slot here, even if
+        // it has never been registered or has been removed since
+        std::vector<ActionData> m_actions;
+        std::unordered_map<ActionID, ActionHandle> m_actionHandles;
+        // the registered actions in display order
+        std::vector<ActionHandle> m_actionOrder;
+        // actions that have been marked dirty since the last save. May
+        // contain actions that have been cleaned since
+        std::vector<ActionHandle> m_dirtyActions;
+        // the contents of the binary bind store, read in one pass when the
+        // manager is created. Actions missing from it are loaded from JSON
+        // entries are never modified once stored, so saving can hand a
+        // snapshot of them to the writer thread without copying them
+        std::unordered_map<ActionID, std::shared_ptr<StoredAction const>> m_store;
+        uint32_t m_storeGeneration = 0;
+        // the sequence number of the last edit written to the journal
+        uint32_t m_journalSeq = 0;
+        std::vector<ActionHandle> m_journalQueue;
+        bool m_journalScheduled = false;
+        bool m_useStore = false;
+        // nesting depth of beginBatch. While a batch is open, releasing
+        // actions, compacting m_actionOrder and scheduling the journal are
+        // put off until the outermost batch ends
+        size_t m_batchDepth = 0;
+        std::vector<ActionHandle> m_batchReleases;
+        // m_actionOrder may contain actions removed during the batch
+        bool m_actionOrderStale = false;
+        std::vector<Category> m_categories;
+        geode::EventListener<PressBindFilter> m_listener =
+            geode::EventListener<PressBindFilter>(this, &BindManager::onDispatch);
+        // forwards InvokeBindEvents posted by other mods to ActionListeners
+        geode::EventListener<geode::EventFilter<InvokeBindEvent>> m_invokeListener =
+            geode::EventListener<geode::EventFilter<InvokeBindEvent>>(this, &BindManager::onInvoke);
+        size_t m_dispatchDepth = 0;
+        std::vector<ActionHandle> m_staleListeners;
+        // min-heap of repeat timers by deadline. Timers aren't removed when
+        // their action stops repeating, they're skipped when they come up
+        std::vector<RepeatTimer> m_repeatQueue;
+        // seconds onRepeat has been scheduled for in total; the timers'
+        // deadlines are relative to this
+        double m_repeatClock = 0.0;
+        size_t m_activeRepeats = 0;
+        bool m_repeatScheduled = false;
+        bool m_lazyLoading = false;
+        // the keys the saved or default binds of the actions that haven't
+        // been loaded yet are on. Actions aren't removed from it when
+        // they're loaded by something else
+        std::unordered_map<BindKey, std::vector<ActionHandle>> m_pendingKeys;
+        size_t m_pendingActions = 0;
+        bool m_profiling = false;
+        bool m_postingAllInvokes = true;
+        std::array<LatencyHistogram, LATENCY_STAGE_COUNT> m_stageLatencies;
+        // keyboard keys are Windows virtual-key codes, so the controller
+        // buttons are the highest key codes there are
+        static constexpr size_t KEY_CODE_COUNT = cocos2d::CONTROLLER_RTHUMBSTICK_RIGHT + 1;
+        std::bitset<KEY_CODE_COUNT> m_heldKeys;
+        // for each keyboard key, bit N is set if the key has a bind with
+        // the modifiers N. Lets modifier changes skip held keys without binds.
+        // Binds with modifiers outside the four flags aren't tracked here
+        std::array<uint16_t, 0x100> m_boundModifiers {};
+        // indexed by ActionHandle, grown when an action is first held
+        std::vector<bool> m_heldActions;
+
+        BindManager();
+
+        geode::ListenerResult onDispatch(PressBindEvent* event);
+        geode::ListenerResult onInvoke(InvokeBindEvent* event);
+        geode::ListenerResult invokeListeners(InvokeBindEvent* event);
+        void addListener(ActionListener* listener);
+        void removeListener(ActionListener* listener);
+        void onRepeat(float dt);
+        void repeat(ActionHandle action);
+        void unrepeat(ActionHandle action);
+        bool isRepeating(ActionHandle action) const;
+        void pushRepeatTimer(RepeatTimer timer);
+        /**
+         * Stop an action from being held or repeating, for when it loses the
+         * bind that was holding it
+         */
+        void release(ActionHandle action);
+        void compactActionOrder();
+        /**
+         * Count an InvokeBindFilter for an action. Filters can be made with
+         * invalid handles, which are ignored, and this never throws so it's
+         * safe to call from their destructors
+         */
+        void countLegacyFilter(ActionHandle action, bool added) noexcept;
+        void setActionHeld(ActionHandle action, bool held);
+        void setKeyBound(BindKey key, bool bound);
+        void markDirty(ActionHandle action);
+        void recordLatency(LatencyStage stage, Timestamp from, Timestamp to);
+
+        uint16_t registerDevice(DeviceID const& device);
+        BindKey internBind(Bind* bind);
+        void bind(ActionHandle action, BindKey key);
+        void unbind(ActionHandle action, BindKey key);
+        void bindOrDefer(ActionHandle action, BindKey key);
+        bool isAttached(BindKey key) const;
+        void bindDefaults(ActionHandle action);
+        void loadBinds(ActionHandle action);
+        /**
+         * Put off loading an action's binds until they're needed. Returns
+         * false if the action has to be loaded now, because the keys of its
+         * binds can't be known without loading them
+         */
+        bool deferLoad(ActionHandle action);
+        /**
+         * Stop the action's binds from being loaded later. Returns true if
+         * they hadn't been loaded yet
+         */
+        bool takePending(ActionHandle action);
+        void loadPending(ActionHandle action);
+        void loadPending(ActionID const& action);
+        void loadPendingFor(BindKey key);
+        ActionData const* findAction(ActionID const& action) const;
+        /**
+         * Get the data of a registered action. Returns null if the action
+         * isn't registered
+         */
+        ActionData* getActionData(ActionHandle action);
+        ActionData* getActionData(ActionID const& action);
+        ActionData const* getActionData(ActionID const& action) const;
+        std::optional<RepeatOptions> getRepeatOptionsFor(ActionHandle action);
+
+        bool loadActionBinds(ActionID const& action);
+        void saveActionBinds(ActionID const& action);
+        matjson::Array getSavedBinds(ActionID const& action) const;
+        std::shared_ptr<StoredAction const> createStoredAction(ActionID const& action);
+        bool loadStoredBinds(ActionID const& action);
+        void readStore();
+        void replayJournal();
+        void writeStore() const;
+        void queueJournal(ActionHandle action);
+        void scheduleJournal();
+        void flushJournal();
+
+        friend class InvokeBindFilter;
+        friend class ActionListener;
+        friend struct StoreFormat;
+        friend struct matjson::Serialize<BindSaveData>;
+
+    public:
+        static BindManager* get();
+        void save();
+
+        void attachDevice(DeviceID const& device, BindParser parser);
+        void detachDevice(DeviceID const& device);
+        /**
+         * Get the ordinal BindKeys use for a device. A device gets its
+         * ordinal when it's first attached and keeps it for the rest of the
+         * session, even if it's detached
+         * @returns The ordinal, or 0 if the device has never been attached
+         */
+        uint16_t getDeviceOrdinal(DeviceID const& device) const;
+
+        matjson::Value saveBind(Bind* bind) const;
+        Bind* loadBind(matjson::Value const& json) const;
+
+        /**
+         * Get the packed key for a bind. Empty if the bind's device has
+         * never been attached, or if it's from a custom device and has never
+         * been bound to anything
+         */
+        BindKey getKeyFor(Bind* bind) const;
+        /**
+         * Get the bind object a packed key refers to. Binds from the built-in
+         * devices are created on every call
+         * @returns The bind, or null if the key doesn't refer to a known bind
+         */
+        Bind* createBind(BindKey key) const;
+
+        /**
+         * Get the handle of an action ID. IDs that haven't been seen before
+         * are interned, so this can be called before the action is registered
+         */
+        ActionHandle getActionHandle(ActionID const& action);
+        /**
+         * Get the handle of an action ID without interning it
+         * @returns The handle, or an invalid handle if the ID hasn't been
+         * seen before
+         */
+        ActionHandle findActionHandle(ActionID const& action) const;
+        /**
+         * Get the ID of an action handle
+         * @returns The ID, or an empty string if the handle is invalid
+         */
+        ActionID getActionID(ActionHandle handle) const;
+        /**
+         * Invoke an action: post an InvokeBindEvent if isPostingAllInvokes
+         * is on or any InvokeBindFilters are listening to it, and then call
+         * its ActionListeners unless the event was stopped
+         */
+        geode::ListenerResult invoke(
+            ActionHandle action, bool down,
+            std::optional<Timestamp> timestamp = std::nullopt
+        );
+
+        /**
+         * Register a new bindable action. Use getActionHandle to get its
+         * handle afterwards
+         * @returns False if an action with the same ID is already registered
+         */
+        bool registerBindable(BindableAction const& action, ActionID const& after = "");
+        /**
+         * Register many bindable actions at once. Cheaper than registering
+         * them one by one, as they're placed in the display order together,
+         * each of their categories is only added once and the upkeep is done
+         * in one batch
+         * @param actions The actions to register, in display order
+         * @param after The ID of the action to place the actions after. If
+         * empty or not registered, they're placed last
+         * @returns The handles of the actions in the same order. A handle is
+         * invalid if an action with the same ID was already registered or
+         * comes earlier in the span
+         */
+        std::vector<ActionHandle> registerBindables(
+            std::span<BindableAction const> actions, ActionID const& after = ""
+        );
+        std::vector<ActionHandle> registerBindables(
+            std::span<BindableDescriptor const> actions, ActionID const& after = ""
+        );
+        void removeBindable(ActionID const& action);
+        std::optional<BindableAction> getBindable(ActionID const& action) const;
+        std::vector<BindableAction> getAllBindables() const;
+        std::vector<BindableAction> getBindablesIn(Category const& category, bool sub = false) const;
+        std::vector<BindableAction> getBindablesFor(Bind* bind) const;
+        /**
+         * Get the actions a key is bound to. This is a single lookup no
+         * matter how many actions are registered
+         */
+        std::vector<BindableAction> getBindablesFor(BindKey key) const;
+        std::vector<Category> getAllCategories() const;
+        /**
+         * Add a new bindable category. If the category is a subcategory (its
+         * ID has a slash, like "Editor/Modify"), then all its parent
+         * categories are inserted aswell, and the subcategory is added after
+         * its parent's last subcategory
+         * @param category The category to add. Specify a subcategory by
+         * including a slash in the name (like "Editor/Modify")
+         */
+        void addCategory(Category const& category);
+        /**
+         * @note Also removes all the bindables in this category
+         */
+        void removeCategory(Category const& category);
+
+        void addBindTo(ActionID const& action, Bind* bind);
+        void removeBindFrom(ActionID const& action, Bind* bind);
+        void removeAllBindsFrom(ActionID const& action);
+        void resetBindsToDefault(ActionID const& action);
+        /**
+         * Reset the binds of every registered action to their defaults in
+         * one batch
+         */
+        void resetAllBindsToDefault();
+        bool hasDefaultBinds(ActionID const& action) const;
+        std::vector<geode::Ref<Bind>> getBindsFor(ActionID const& action) const;
+
+        std::optional<RepeatOptions> getRepeatOptionsFor(ActionID const& action);
+        void setRepeatOptionsFor(ActionID const& action, RepeatOptions const& options);
+        void stopAllRepeats();
+
+        /**
+         * Start a batch of mutations. Until the matching endBatch, the
+         * upkeep that adding, removing and resetting binds and bindables
+         * does after every call is deferred, and done once for the whole
+         * batch when the outermost batch ends. Batches can be nested. Prefer
+         * BindBatch, which ends the batch even if an exception is thrown
+         */
+        void beginBatch();
+        void endBatch();
+        bool isBatching() const;
+
+        /**
+         * Check if a key or controller button is currently held down. Held
+         * keys are tracked by the keyboard dispatcher hook
+         */
+        bool isKeyHeld(cocos2d::enumKeyCodes key) const;
+        /**
+         * Mark a key as held or released. Only needed if you're sending key
+         * presses to the game that don't go through CCKeyboardDispatcher
+         */
+        void setKeyHeld(cocos2d::enumKeyCodes key, bool held);
+        /**
+         * Check if any of the binds of an action is currently held down
+         */
+        bool isActionHeld(ActionHandle action) const;
+        bool isActionHeld(ActionID const& action) const;
+        /**
+         * Check if any action is bound to a keyboard key with exactly these
+         * modifiers. Cheaper than posting a PressBindEvent to find out
+         */
+        bool isKeyBound(cocos2d::enumKeyCodes key, Modifier modifiers) const;
+
+        /**
+         * Start or stop measuring how long it takes for inputs to reach the
+         * listeners of the actions they invoke. Latencies recorded so far
+         * are kept when profiling is stopped
+         */
+        void setProfiling(bool enabled);
+        bool isProfiling() const;
+        /**
+         * Set whether every invoked action posts an InvokeBindEvent through
+         * Geode's event system, or only the ones an InvokeBindFilter is
+         * listening to. Posting all of them keeps mods that listen with
+         * their own EventFilter<InvokeBindEvent> working, and is on by
+         * default
+         */
+        void setPostingAllInvokes(bool enabled);
+        bool isPostingAllInvokes() const;
+        /**
+         * Get the latencies from inputs reaching the game until the action's
+         * listeners had been called. Null if the action hasn't been invoked
+         * by an input while profiling
+         */
+        LatencyHistogram const* getLatencyFor(ActionID const& action) const;
+        LatencyHistogram const& getLatencyFor(LatencyStage stage) const;
+        void resetLatencies();
+        /**
+         * Write a summary of all recorded latencies to a file. Returns false
+         * if the file couldn't be written
+         */
+        bool dumpLatencies(std::filesystem::path const& path) const;
+    };
+
+    /**
+     * Keeps a BindManager batch open for as long as it's alive
+     */
+    class CUSTOM_KEYBINDS_DLL BindBatch final {
+    public:
+        BindBatch();
+        ~BindBatch();
+        BindBatch(BindBatch const&) = delete;
+        BindBatch& operator=(BindBatch const&) = delete;
+    };
+}
@@ -1,6 +1,9 @@
 #include <Geode/modify/EditorUI.hpp>
 #include <Geode/modify/EditorPauseLayer.hpp>
+#include <algorithm>
+#include <array>
 #include <unordered_map>
+#include <utility>
 #include <unordered_set>
 #include "../include/Keybinds.hpp"
 #include "Geode/Enums.hpp"
@@ -36,6 +39,14 @@ public:
 };
 
 struct $modify(EditorPauseLayer) {
+    struct Fields {
+        std::vector<Ref<ActionListener>> m_listeners;
+    };
+
+    void addActionListener(MiniFunction<ActionListener::Callback> callback, ActionID const& id) {
+        m_fields->m_listeners.push_back(ActionListener::create(id, callback));
+    }
+
     static void onModify(auto& self) {
         (void)self.setHookPriority("EditorPauseLayer::keyDown", 1000);
     }
@@ -43,7 +54,7 @@ struct $modify(EditorPauseLayer) {
     void customSetup() {
         EditorPauseLayer::customSetup();
 
-        this->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             if (event->isDown()) {
                 this->onResume(nullptr);
                 return ListenerResult::Stop;
@@ -60,6 +71,14 @@ struct $modify(EditorPauseLayer) {
 };
 
 struct $modify(EditorUI) {
+    struct Fields {
+        std::vector<Ref<ActionListener>> m_listeners;
+    };
+
+    void addActionListener(MiniFunction<ActionListener::Callback> callback, ActionID const& id) {
+        m_fields->m_listeners.push_back(ActionListener::create(id, callback));
+    }
+
     static void onModify(auto& self) {
         (void)self.setHookPriority("EditorUI::keyDown", 1000000);
         (void)self.setHookPriority("EditorUI::keyUp", 1000);
@@ -270,14 +289,14 @@ struct $modify(EditorUI) {
     }
 
     void defineKeybind(std::string const& id, std::function<void(bool)> callback) {
-        this->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             callback(event->isDown());
             return ListenerResult::Propagate;
         }, id);
     }
 
     void defineKeybind(std::string const& id, std::function<void()> callback) {
-        this->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             if (event->isDown()) {
                 callback();
             }
@@ -318,337 +337,391 @@ struct $modify(EditorUI) {
     }
 };
 
-$execute {
-    BindManager::get()->registerBindable({
+static constexpr BindableDescriptor EDITOR_BINDABLES_BEFORE_POSITIONS[] = {
+    {
         "robtop.geometry-dash/build-mode",
         "Build Mode",
         "Toggle the Build Tab",
-        { Keybind::create(KEY_One, Modifier::None) },
+        { BindKey::keyboard(KEY_One, Modifier::None) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/edit-mode",
         "Edit Mode",
         "Toggle the Edit Tab",
-        { Keybind::create(KEY_Two, Modifier::None) },
+        { BindKey::keyboard(KEY_Two, Modifier::None) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/delete-mode",
         "Delete Mode",
         "Toggle the Delete Tab",
-        { Keybind::create(KEY_Three, Modifier::None) },
+        { BindKey::keyboard(KEY_Three, Modifier::None) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/rotate-ccw",
         "Rotate CCW",
         "Rotate Object(s) Counter-Clockwise",
-        { Keybind::create(KEY_Q, Modifier::None) },
+        { BindKey::keyboard(KEY_Q, Modifier::None) },
         Category::EDITOR_MODIFY, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/rotate-cw",
         "Rotate CW",
         "Rotate Object(s) Clockwise",
-        { Keybind::create(KEY_E, Modifier::None) },
+        { BindKey::keyboard(KEY_E, Modifier::None) },
         Category::EDITOR_MODIFY, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/flip-x",
         "Flip X",
         "Flip Object(s) Along the X-Axis",
-        { Keybind::create(KEY_Q, Modifier::Alt) },
+        { BindKey::keyboard(KEY_Q, Modifier::Alt) },
         Category::EDITOR_MODIFY, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/flip-y",
         "Flip Y",
         "Flip Object(s) Along the Y-Axis",
-        { Keybind::create(KEY_E, Modifier::Alt) },
+        { BindKey::keyboard(KEY_E, Modifier::Alt) },
         Category::EDITOR_MODIFY, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/delete",
         "Delete Selected",
         "Delete Selected Object(s)",
-        { Keybind::create(KEY_Delete, Modifier::None) },
+        { BindKey::keyboard(KEY_Delete, Modifier::None) },
         Category::EDITOR_MODIFY, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/undo",
         "Undo",
         "Undo Last Action",
-        { Keybind::create(KEY_Z, Modifier::PlatformControl) },
+        { BindKey::keyboard(KEY_Z, Modifier::PlatformControl) },
         Category::EDITOR_MODIFY, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/redo",
         "Redo",
         "Redo Last Action",
-        { Keybind::create(KEY_Z, Modifier::PlatformControl | Modifier::Shift) },
+        {
+            BindKey::keyboard(KEY_Z, Modifier::PlatformControl | Modifier::Shift)
+        },
         Category::EDITOR_MODIFY, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/deselect-all",
         "Deselect All",
         "Deselect All Objects",
-        { Keybind::create(KEY_D, Modifier::Alt) },
+        { BindKey::keyboard(KEY_D, Modifier::Alt) },
         Category::EDITOR_MODIFY, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/copy",
         "Copy",
         "Copy Selected Objects",
-        { Keybind::create(KEY_C, Modifier::PlatformControl) },
+        { BindKey::keyboard(KEY_C, Modifier::PlatformControl) },
         Category::EDITOR_MODIFY, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/paste",
         "Paste",
         "Paste Selected Objects",
-        { Keybind::create(KEY_V, Modifier::PlatformControl) },
+        { BindKey::keyboard(KEY_V, Modifier::PlatformControl) },
         Category::EDITOR_MODIFY, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/copy-paste",
         "Copy + Paste",
         "Duplicate Selected Objects",
-        { Keybind::create(KEY_D, Modifier::PlatformControl) },
+        { BindKey::keyboard(KEY_D, Modifier::PlatformControl) },
         Category::EDITOR_MODIFY, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/toggle-rotate",
         "Rotate",
         "Toggle Rotate Control",
-        { Keybind::create(KEY_R, Modifier::None) },
+        { BindKey::keyboard(KEY_R, Modifier::None) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/toggle-transform",
         "Transform",
         "Toggle Transform Control",
-        { Keybind::create(KEY_T, Modifier::PlatformControl) },
+        { BindKey::keyboard(KEY_T, Modifier::PlatformControl) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/toggle-free-move",
         "Free Move",
         "Toggle Free Move",
-        { Keybind::create(KEY_F, Modifier::None) },
+        { BindKey::keyboard(KEY_F, Modifier::None) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/toggle-swipe",
         "Swipe",
         "Toggle Swipe",
-        { Keybind::create(KEY_T, Modifier::None) },
+        { BindKey::keyboard(KEY_T, Modifier::None) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/toggle-snap",
         "Snap",
         "Toggle Snap",
-        { Keybind::create(KEY_G, Modifier::None) },
+        { BindKey::keyboard(KEY_G, Modifier::None) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/playtest",
         "Playtest",
         "Start / Stop Playtesting",
-        { Keybind::create(KEY_Enter, Modifier::None), ControllerBind::create(CONTROLLER_Y) },
+        {
+            BindKey::keyboard(KEY_Enter, Modifier::None),
+            BindKey::controller(CONTROLLER_Y)
+        },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/playback-music",
         "Playback Music",
         "Start / Stop Playing the Level's Music",
-        { Keybind::create(KEY_Enter, Modifier::PlatformControl) },
+        { BindKey::keyboard(KEY_Enter, Modifier::PlatformControl) },
         Category::EDITOR_UI, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/prev-build-tab",
         "Previous Build Tab",
         "",
         {},
         Category::EDITOR_UI, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/next-build-tab",
         "Next Build Tab",
         "",
         {},
         Category::EDITOR_UI, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/next-layer",
         "Next Layer",
         "Go to Next Editor Layer",
-        { Keybind::create(KEY_Right, Modifier::None) },
+        { BindKey::keyboard(KEY_Right, Modifier::None) },
         Category::EDITOR_UI, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/prev-layer",
         "Previous Layer",
         "Go to Previous Editor Layer",
-        { Keybind::create(KEY_Left, Modifier::None) },
+        { BindKey::keyboard(KEY_Left, Modifier::None) },
         Category::EDITOR_UI, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/scroll-up",
         "Scroll Up",
         "",
-        { Keybind::create(KEY_OEMPlus, Modifier::None) },
+        { BindKey::keyboard(KEY_OEMPlus, Modifier::None) },
         Category::EDITOR_UI, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/scroll-down",
         "Scroll Down",
         "",
-        { Keybind::create(KEY_OEMMinus, Modifier::None) },
+        { BindKey::keyboard(KEY_OEMMinus, Modifier::None) },
         Category::EDITOR_UI, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/zoom-in",
         "Zoom In",
         "",
-        { Keybind::create(KEY_OEMPlus, Modifier::Shift) },
+        { BindKey::keyboard(KEY_OEMPlus, Modifier::Shift) },
         Category::EDITOR_UI, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/zoom-out",
         "Zoom Out",
         "",
-        { Keybind::create(KEY_OEMMinus, Modifier::Shift) },
+        { BindKey::keyboard(KEY_OEMMinus, Modifier::Shift) },
         Category::EDITOR_UI, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/lock-preview",
         "Lock Preview",
         "Locks the editor preview line at the center of the camera",
-        { Keybind::create(KEY_F1) },
-        Category::EDITOR_UI, 
-        false
-    });
-    BindManager::get()->registerBindable({
+        { BindKey::keyboard(KEY_F1) },
+        Category::EDITOR_UI, false
+    },
+    {
         "robtop.geometry-dash/unlock-preview",
         "Unlock Preview",
         "Unlocks the editor preview line",
-        { Keybind::create(KEY_F2) },
-        Category::EDITOR_UI, 
-        false
-    });
-    BindManager::get()->registerBindable({
+        { BindKey::keyboard(KEY_F2) },
+        Category::EDITOR_UI, false
+    },
+    {
         "robtop.geometry-dash/toggle-preview-mode",
         "Toggle Preview Mode",
         "Toggles preview mode ON/OFF",
-        { Keybind::create(KEY_F3) },
-        Category::EDITOR_UI, 
-        false
-    });
-    BindManager::get()->registerBindable({
+        { BindKey::keyboard(KEY_F3) },
+        Category::EDITOR_UI, false
+    },
+    {
         "robtop.geometry-dash/toggle-particle-icons",
         "Toggle Particle Icons",
         "Toggles between showing particles or showing their icons",
-        { Keybind::create(KEY_F4) },
-        Category::EDITOR_UI, 
-        false
-    });
-    BindManager::get()->registerBindable({
+        { BindKey::keyboard(KEY_F4) },
+        Category::EDITOR_UI, false
+    },
+    {
         "robtop.geometry-dash/toggle-editor-hitboxes",
         "Toggle Editor Hitboxes",
         "Toggles hitboxes in the editor",
-        { Keybind::create(KEY_F5) },
-        Category::EDITOR_UI, 
-        false
-    });
-    BindManager::get()->registerBindable({
+        { BindKey::keyboard(KEY_F5) },
+        Category::EDITOR_UI, false
+    },
+    {
         "robtop.geometry-dash/toggle-hide-invisible",
         "Toggle Hide Invisible",
         "Toggles visibility of hidden objects",
-        { Keybind::create(KEY_F6) },
-        Category::EDITOR_UI, 
-        false
-    });
-    BindManager::get()->registerBindable({
+        { BindKey::keyboard(KEY_F6) },
+        Category::EDITOR_UI, false
+    },
+    {
         "robtop.geometry-dash/move-obj-left",
         "Move Object Left",
         "Move Selected Object(s) Left 1 Block (30 Units)",
-        { Keybind::create(KEY_A, Modifier::None) },
+        { BindKey::keyboard(KEY_A, Modifier::None) },
         Category::EDITOR_MOVE, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/move-obj-right",
         "Move Object Right",
         "Move Selected Object(s) Right 1 Block (30 Units)",
-        { Keybind::create(KEY_D, Modifier::None) },
+        { BindKey::keyboard(KEY_D, Modifier::None) },
         Category::EDITOR_MOVE, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/move-obj-up",
         "Move Object Up",
         "Move Selected Object(s) Up 1 Block (30 Units)",
-        { Keybind::create(KEY_W, Modifier::None) },
+        { BindKey::keyboard(KEY_W, Modifier::None) },
         Category::EDITOR_MOVE, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/move-obj-down",
         "Move Object Down",
         "Move Selected Object(s) Down 1 Block (30 Units)",
-        { Keybind::create(KEY_S, Modifier::None) },
+        { BindKey::keyboard(KEY_S, Modifier::None) },
         Category::EDITOR_MOVE, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/move-obj-left-small",
         "Move Object Left Small",
         "Move Selected Object(s) Left 2 Units",
-        { Keybind::create(KEY_A, Modifier::Shift) },
+        { BindKey::keyboard(KEY_A, Modifier::Shift) },
         Category::EDITOR_MOVE, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/move-obj-right-small",
         "Move Object Right Small",
         "Move Selected Object(s) Right 2 Units",
-        { Keybind::create(KEY_D, Modifier::Shift) },
+        { BindKey::keyboard(KEY_D, Modifier::Shift) },
         Category::EDITOR_MOVE, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/move-obj-up-small",
         "Move Object Up Small",
         "Move Selected Object(s) Up 2 Units",
-        { Keybind::create(KEY_W, Modifier::Shift) },
+        { BindKey::keyboard(KEY_W, Modifier::Shift) },
         Category::EDITOR_MOVE, true
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/move-obj-down-small",
         "Move Object Down Small",
         "Move Selected Object(s) Down 2 Units",
-        { Keybind::create(KEY_S, Modifier::Shift) },
+        { BindKey::keyboard(KEY_S, Modifier::Shift) },
         Category::EDITOR_MOVE, true
-    });
-    for (size_t i = 0; i < 10; i += 1) {
-        auto x = std::to_string(i);
-        BindManager::get()->registerBindable({
-            "robtop.geometry-dash/save-editor-position-" + x,
-            "Save Editor Position " + x,
-            "Save the current editor camera position in the slot " + x + ". "
-            "You can reload this slot back with Load Editor Position " + x,
-            { Keybind::create(static_cast<enumKeyCodes>(KEY_Zero + i), Modifier::PlatformControl) },
+    },
+};
+
+// A string with every '#' replaced by a digit, for generating the strings of
+// the numbered bindables at compile time
+template <size_t N>
+struct DigitString {
+    char value[N] {};
+
+    consteval DigitString(const char (&str)[N], size_t digit) {
+        for (size_t i = 0; i < N; i++) {
+            value[i] = str[i] == '#' ? static_cast<char>('0' + digit) : str[i];
+        }
+    }
+};
+
+template <size_t Slot>
+struct EditorPositionStrings {
+    static constexpr DigitString SAVE_ID { "robtop.geometry-dash/save-editor-position-#", Slot };
+    static constexpr DigitString SAVE_NAME { "Save Editor Position #", Slot };
+    static constexpr DigitString SAVE_DESCRIPTION {
+        "Save the current editor camera position in the slot #. "
+        "You can reload this slot back with Load Editor Position #", Slot
+    };
+    static constexpr DigitString LOAD_ID { "robtop.geometry-dash/load-editor-position-#", Slot };
+    static constexpr DigitString LOAD_NAME { "Load Editor Position #", Slot };
+    static constexpr DigitString LOAD_DESCRIPTION {
+        "Load the current editor camera position in the slot #", Slot
+    };
+};
+
+template <size_t... Slots>
+static consteval auto editorPositionBindables(std::index_sequence<Slots...>) {
+    std::array<BindableDescriptor, sizeof...(Slots) * 2> res {};
+    size_t i = 0;
+    ((
+        res[i++] = {
+            EditorPositionStrings<Slots>::SAVE_ID.value,
+            EditorPositionStrings<Slots>::SAVE_NAME.value,
+            EditorPositionStrings<Slots>::SAVE_DESCRIPTION.value,
+            { BindKey::keyboard(static_cast<enumKeyCodes>(KEY_Zero + Slots), Modifier::PlatformControl) },
             Category::EDITOR_UI, false
-        });
-        BindManager::get()->registerBindable({
-            "robtop.geometry-dash/load-editor-position-" + x,
-            "Load Editor Position " + x,
-            "Load the current editor camera position in the slot " + x,
-            { Keybind::create(static_cast<enumKeyCodes>(KEY_Zero + i), Modifier::Alt) },
+        },
+        res[i++] = {
+            EditorPositionStrings<Slots>::LOAD_ID.value,
+            EditorPositionStrings<Slots>::LOAD_NAME.value,
+            EditorPositionStrings<Slots>::LOAD_DESCRIPTION.value,
+            { BindKey::keyboard(static_cast<enumKeyCodes>(KEY_Zero + Slots), Modifier::Alt) },
             Category::EDITOR_UI, false
-        });
-    }
-    BindManager::get()->registerBindable({
+        }
+    ), ...);
+    return res;
+}
+
+static constexpr BindableDescriptor EDITOR_BINDABLES_AFTER_POSITIONS[] = {
+    {
         "robtop.geometry-dash/pan-editor",
         "Pan Editor While Swiping",
         "Allows you to pan in the editor if you have swipe enabled",
-        { Keybind::create(KEY_Space) },
+        { BindKey::keyboard(KEY_Space) },
         Category::EDITOR_UI, false
-    });
+    },
+};
+
+template <size_t... N>
+static consteval auto joinBindables(std::array<BindableDescriptor, N> const&... parts) {
+    std::array<BindableDescriptor, (N + ...)> res {};
+    size_t i = 0;
+    ((std::copy(parts.begin(), parts.end(), res.begin() + i), i += N), ...);
+    return res;
+}
+
+static constexpr auto EDITOR_POSITION_BINDABLES = editorPositionBindables(std::make_index_sequence<10>());
+static constexpr auto EDITOR_BINDABLES = joinBindables(
+    std::to_array(EDITOR_BINDABLES_BEFORE_POSITIONS),
+    EDITOR_POSITION_BINDABLES,
+    std::to_array(EDITOR_BINDABLES_AFTER_POSITIONS)
+);
+
+$execute {
+    BindManager::get()->registerBindables(EDITOR_BINDABLES);
 }
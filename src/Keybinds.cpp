@@ -1,830 +1,2515 @@
-#include "../include/Keybinds.hpp"
-#include "Geode/cocos/robtop/keyboard_dispatcher/CCKeyboardDelegate.h"
-#include "Geode/cocos/sprite_nodes/CCSprite.h"
-#include "Geode/loader/Event.hpp"
-#include <Geode/utils/ranges.hpp>
-#include <Geode/utils/string.hpp>
-#include <Geode/loader/ModEvent.hpp>
-#include <GUI/CCControlExtension/CCScale9Sprite.h>
-
-using namespace geode::prelude;
-using namespace keybinds;
-
-Modifier keybinds::operator|=(Modifier& a, Modifier const& b) {
-    return static_cast<Modifier>(reinterpret_cast<int&>(a) |= static_cast<int>(b));
-}
-
-Modifier keybinds::operator|(Modifier const& a, Modifier const& b) {
-    return static_cast<Modifier>(static_cast<int>(a) | static_cast<int>(b));
-}
-
-bool keybinds::operator&(Modifier const& a, Modifier const& b) {
-    return static_cast<bool>(static_cast<int>(a) & static_cast<int>(b));
-}
-
-std::string keybinds::keyToString(enumKeyCodes key) {
-    switch (key) {
-        case KEY_None:      return "";
-        case KEY_C:         return "C";
-        case KEY_Multiply:  return "Mul";
-        case KEY_Divide:    return "Div";
-        case KEY_OEMPlus:   return "Plus";
-        case KEY_OEMMinus:  return "Minus";
-        case CONTROLLER_LTHUMBSTICK_DOWN: return "L_THUMBSTICK_DOWN";
-        case CONTROLLER_LTHUMBSTICK_LEFT: return "L_THUMBSTICK_LEFT";
-        case CONTROLLER_LTHUMBSTICK_UP: return "L_THUMBSTICK_UP";
-        case CONTROLLER_LTHUMBSTICK_RIGHT: return "L_THUMBSTICK_RIGHT";
-        case CONTROLLER_RTHUMBSTICK_RIGHT: return "R_THUMBSTICK_RIGHT";
-        case CONTROLLER_RTHUMBSTICK_LEFT: return "L_THUMBSTICK_RIGHT";
-        case CONTROLLER_RTHUMBSTICK_DOWN: return "L_THUMBSTICK_DOWN";
-        case CONTROLLER_RTHUMBSTICK_UP: return "L_THUMBSTICK_UP";
-        case static_cast<enumKeyCodes>(-1): return "Unk";
-        default: return CCKeyboardDispatcher::get()->keyToString(key);
-    }
-}
-
-bool keybinds::keyIsModifier(enumKeyCodes key) {
-    return
-        key == KEY_Control ||
-        key == KEY_LeftControl ||
-        key == KEY_RightContol ||
-        key == KEY_Shift ||
-        key == KEY_LeftShift ||
-        key == KEY_RightShift ||
-        key == KEY_Alt ||
-        key == KEY_LeftWindowsKey ||
-        key == KEY_RightWindowsKey;
-}
-
-bool keybinds::keyIsController(enumKeyCodes key) {
-    return key >= CONTROLLER_A && key <= CONTROLLER_RTHUMBSTICK_RIGHT;
-}
-
-bool Bind::isEqual(Bind* other) const {
-    return this->getHash() == other->getHash();
-}
-
-CCNode* Bind::createLabel() const {
-    return CCLabelBMFont::create(this->toString().c_str(), "goldFont.fnt");
-}
-
-CCNodeRGBA* Bind::createBindSprite() const {
-    auto bg = CCScale9Sprite::create("square.png"_spr);
-    bg->setOpacity(85);
-    bg->setColor({ 0, 0, 0 });
-    bg->setScale(.45f);
-
-    auto top = this->createLabel();
-    limitNodeSize(top, { 125.f, 30.f }, 1.f, .1f);
-    bg->setContentSize({
-        clamp(top->getScaledContentSize().width + 18.f, 18.f / bg->getScale(), 145.f),
-        18.f / bg->getScale()
-    });
-    bg->addChild(top);
-
-    top->setPosition(bg->getContentSize() / 2);
-
-    return bg;
-}
-
-Keybind* Keybind::create(enumKeyCodes key, Modifier modifiers) {
-    if (key == KEY_None || key == KEY_Unknown || keyIsController(key)) {
-        return nullptr;
-    }
-    auto ret = new Keybind();
-    ret->m_key = key;
-    ret->m_modifiers = modifiers;
-    ret->autorelease();
-    return ret;
-}
-
-Keybind* Keybind::parse(matjson::Value const& value) {
-    return Keybind::create(
-        static_cast<enumKeyCodes>(value["key"].as_int()),
-        static_cast<Modifier>(value["modifiers"].as_int())
-    );
-}
-
-matjson::Value Keybind::save() const {
-    return matjson::Object {
-        { "key", static_cast<int>(m_key) },
-        { "modifiers", static_cast<int>(m_modifiers) }
-    };
-}
-
-enumKeyCodes Keybind::getKey() const {
-    return m_key;
-}
-
-Modifier Keybind::getModifiers() const {
-    return m_modifiers;
-}
-
-size_t Keybind::getHash() const {
-    return m_key | (static_cast<int>(m_modifiers) << 29);
-}
-
-bool Keybind::isEqual(Bind* other) const {
-    if (auto o = typeinfo_cast<Keybind*>(other)) {
-        return m_key == o->m_key && m_modifiers == o->m_modifiers;
-    }
-    return false;
-}
-
-std::string Keybind::toString() const {
-    std::string res = "";
-    if (m_modifiers & Modifier::Control) {
-        res += "Ctrl + ";
-    }
-    if (m_modifiers & Modifier::Command) {
-        res += "Cmd + ";
-    }
-    if (m_modifiers & Modifier::Shift) {
-        res += "Shift + ";
-    }
-    if (m_modifiers & Modifier::Alt) {
-        res += "Alt + ";
-    }
-    res += keyToString(m_key);
-    return res;
-}
-
-std::string Keybind::getDeviceID() const {
-    return "keyboard"_spr;
-}
-
-ControllerBind* ControllerBind::create(enumKeyCodes button) {
-    if (!keyIsController(button)) {
-        return nullptr;
-    }
-    auto ret = new ControllerBind();
-    ret->m_button = button;
-    ret->autorelease();
-    return ret;
-}
-
-ControllerBind* ControllerBind::parse(matjson::Value const& value) {
-    return ControllerBind::create(
-        static_cast<enumKeyCodes>(value["button"].as_double())
-    );
-}
-
-matjson::Value ControllerBind::save() const {
-    return matjson::Object {
-        { "button", static_cast<int>(m_button) },
-    };
-}
-
-enumKeyCodes ControllerBind::getButton() const {
-    return m_button;
-}
-
-size_t ControllerBind::getHash() const {
-    return m_button;
-}
-
-bool ControllerBind::isEqual(Bind* other) const {
-    if (auto o = typeinfo_cast<ControllerBind*>(other)) {
-        return m_button == o->m_button;
-    }
-    return false;
-}
-
-std::string ControllerBind::toString() const {
-    return keyToString(m_button);
-}
-
-CCNode* ControllerBind::createLabel() const {
-    const char* sprite;
-    switch (m_button) {
-        case CONTROLLER_A: sprite = "controllerBtn_A_001.png"; break;
-        case CONTROLLER_B: sprite = "controllerBtn_B_001.png"; break;
-        case CONTROLLER_X: sprite = "controllerBtn_X_001.png"; break;
-        case CONTROLLER_Y: sprite = "controllerBtn_Y_001.png"; break;
-        case CONTROLLER_Back: sprite = "controllerBtn_Back_001.png"; break;
-        case CONTROLLER_Start: sprite = "controllerBtn_Start_001.png"; break;
-        case CONTROLLER_Down: sprite = "controllerBtn_DPad_Down_001.png"; break;
-        case CONTROLLER_Left: sprite = "controllerBtn_DPad_Left_001.png"; break;
-        case CONTROLLER_Up: sprite = "controllerBtn_DPad_Up_001.png"; break;
-        case CONTROLLER_Right: sprite = "controllerBtn_DPad_Right_001.png"; break;
-        case CONTROLLER_LT: sprite = "controllerBtn_LT_001.png"_spr; break;
-        case CONTROLLER_RT: sprite = "controllerBtn_RT_001.png"_spr; break;
-        // todo: are these the same
-        case CONTROLLER_LB: sprite = "controllerBtn_LB_001.png"_spr; break;
-        case CONTROLLER_RB: sprite = "controllerBtn_RB_001.png"_spr; break;
-        case CONTROLLER_LTHUMBSTICK_DOWN: sprite = "controllerBtn_LThumb_001.png"; break;
-        case CONTROLLER_LTHUMBSTICK_LEFT: sprite = "controllerBtn_LThumb_001.png"; break;
-        case CONTROLLER_LTHUMBSTICK_RIGHT: sprite = "controllerBtn_LThumb_001.png"; break;
-        case CONTROLLER_LTHUMBSTICK_UP: sprite = "controllerBtn_LThumb_001.png"; break;
-        case CONTROLLER_RTHUMBSTICK_RIGHT: sprite = "controllerBtn_RThumb_001.png"; break;
-        case CONTROLLER_RTHUMBSTICK_DOWN: sprite = "controllerBtn_RThumb_001.png"; break;
-        case CONTROLLER_RTHUMBSTICK_LEFT: sprite = "controllerBtn_RThumb_001.png"; break;
-        case CONTROLLER_RTHUMBSTICK_UP: sprite = "controllerBtn_RThumb_001.png"; break;
-        default: sprite = nullptr;
-    }
-    if (!sprite) {
-        return CCLabelBMFont::create("Unk", "goldFont.fnt");
-    }
-    auto spr = CCSprite::createWithSpriteFrameName(sprite);
-    switch (m_button) {
-        case CONTROLLER_LTHUMBSTICK_DOWN:
-        case CONTROLLER_RTHUMBSTICK_DOWN: {
-            auto arrow = CCSprite::createWithSpriteFrameName("PBtn_Arrow_001.png");
-            arrow->setPosition(ccp(13.f, -5.5f));
-            arrow->setScale(0.7f);
-            spr->addChild(arrow);
-            break;
-        }
-        case CONTROLLER_LTHUMBSTICK_LEFT:
-        case CONTROLLER_RTHUMBSTICK_LEFT: {
-            auto arrow = CCSprite::createWithSpriteFrameName("PBtn_Arrow_001.png");
-            arrow->setPosition(ccp(-5.5f, 13.5f));
-            arrow->setScale(0.7f);
-            arrow->setRotation(90.f);
-            spr->addChild(arrow);
-            break;
-        }
-        case CONTROLLER_LTHUMBSTICK_RIGHT:
-        case CONTROLLER_RTHUMBSTICK_RIGHT: {
-            auto arrow = CCSprite::createWithSpriteFrameName("PBtn_Arrow_001.png");
-            arrow->setPosition(ccp(31.5f, 13.f));
-            arrow->setScale(0.7f);
-            arrow->setRotation(270.f);
-            spr->addChild(arrow);
-            break;
-        }
-        case CONTROLLER_LTHUMBSTICK_UP:
-        case CONTROLLER_RTHUMBSTICK_UP: {
-            auto arrow = CCSprite::createWithSpriteFrameName("PBtn_Arrow_001.png");
-            arrow->setPosition(ccp(13.f, 31.f));
-            arrow->setScale(0.7f);
-            arrow->setRotation(180.f);
-            spr->addChild(arrow);
-            break;
-        }
-
-        default: {}
-    }
-    return spr;
-}
-
-std::string ControllerBind::getDeviceID() const {
-    return "controller"_spr;
-}
-
-BindHash::BindHash(Bind* bind) : bind(bind) {}
-
-bool BindHash::operator==(BindHash const& other) const {
-    return bind->isEqual(other.bind);
-}
-
-std::size_t std::hash<keybinds::BindHash>::operator()(keybinds::BindHash const& hash) const {
-    return hash.bind ? (hash.bind->getHash() | std::hash<std::string>()(hash.bind->getDeviceID())) : 0;
-}
-
-Category::Category(const char* path) : m_value(path) {}
-
-Category::Category(std::string const& path) : m_value(path) {}
-
-std::vector<std::string> Category::getPath() const {
-    return string::split(m_value, "/");
-}
-
-std::optional<Category> Category::getParent() const {
-    if (string::contains(m_value, '/')) {
-        return Category(m_value.substr(0, m_value.find_last_of('/')));
-    }
-    return std::nullopt;
-}
-
-bool Category::hasParent(Category const& parent) const {
-    return m_value.starts_with(parent.m_value);
-}
-
-std::string Category::toString() const {
-    return m_value;
-}
-
-bool Category::operator==(Category const& other) const {
-    return m_value == other.m_value;
-}
-
-std::string BindableAction::getID() const {
-    return m_id;
-}
-
-std::string BindableAction::getName() const {
-    return m_name.empty() ? m_id : m_name;
-}
-
-std::string BindableAction::getDescription() const {
-    return m_description;
-}
-
-Mod* BindableAction::getMod() const {
-    return m_owner;
-}
-
-std::vector<Ref<Bind>> BindableAction::getDefaults() const {
-    return m_defaults;
-}
-
-Category BindableAction::getCategory() const {
-    return m_category;
-}
-
-bool BindableAction::isRepeatable() const {
-    return m_repeatable;
-}
-
-BindableAction::BindableAction(
-    ActionID const& id,
-    std::string const& name,
-    std::string const& description,
-    std::vector<Ref<Bind>> const& defaults,
-    Category const& category,
-    bool repeatable,
-    Mod* owner
-) : m_id(id),
-    m_owner(owner),
-    m_name(name),
-    m_description(description),
-    m_category(category),
-    m_repeatable(repeatable),
-    m_defaults(defaults) {}
-
-InvokeBindEvent::InvokeBindEvent(ActionID const& id, bool down) : m_id(id), m_down(down) {}
-
-std::string InvokeBindEvent::getID() const {
-    return m_id;
-}
-
-bool InvokeBindEvent::isDown() const {
-    return m_down;
-}
-
-ListenerResult InvokeBindFilter::handle(utils::MiniFunction<Callback> fn, InvokeBindEvent* event) {
-    if (event->getID() == m_id) {
-        return fn(event);
-    }
-    return ListenerResult::Propagate;
-}
-
-InvokeBindFilter::InvokeBindFilter(CCNode* target, ActionID const& id)
-  : m_target(target), m_id(id) {
-    BindManager::get()->stopAllRepeats();
-}
-
-PressBindEvent::PressBindEvent(Bind* bind, bool down) : m_bind(bind), m_down(down) {}
-
-Bind* PressBindEvent::getBind() const {
-    return m_bind;
-}
-
-bool PressBindEvent::isDown() const {
-    return m_down;
-}
-
-geode::ListenerResult PressBindFilter::handle(MiniFunction<Callback> fn, PressBindEvent* event) {
-    return fn(event);
-}
-
-PressBindFilter::PressBindFilter() {}
-
-DeviceEvent::DeviceEvent(DeviceID const& id, bool attached)
-  : m_id(id), m_attached(attached) {}
-
-DeviceID DeviceEvent::getID() const {
-    return m_id;
-}
-
-bool DeviceEvent::wasAttached() const {
-    return m_attached;
-}
-
-bool DeviceEvent::wasDetached() const {
-    return !m_attached;
-}
-
-ListenerResult DeviceFilter::handle(MiniFunction<Callback> fn, DeviceEvent* event) {
-    if (!m_id || m_id == event->getID()) {
-        fn(event);
-    }
-    return ListenerResult::Propagate;
-}
-
-DeviceFilter::DeviceFilter(std::optional<DeviceID> id) : m_id(id) {}
-
-BindManager::BindManager() {
-    this->addCategory(Category::GLOBAL);
-    this->addCategory(Category::PLAY);
-    this->addCategory(Category::EDITOR);
-    this->attachDevice("keyboard"_spr, &Keybind::parse);
-    this->retain();
-}
-
-BindManager* BindManager::get() {
-    static auto inst = new BindManager();
-    return inst;
-}
-
-void BindManager::attachDevice(DeviceID const& device, BindParser parser) {
-    if (m_devices.contains(device)) return;
-    m_devices.insert({ device, parser });
-    for (auto& [action, binds] : m_devicelessBinds[device]) {
-        for (auto& data : binds) {
-            // parser may fail
-            try {
-                if (auto nbind = parser(data)) {
-                    this->addBindTo(action, nbind);
-                }
-            }
-            catch(...) {}
-        }
-    }
-    m_devicelessBinds.erase(device);
-    DeviceEvent(device, true).post();
-}
-
-void BindManager::detachDevice(DeviceID const& device) {
-    // Remove all binds related to this device from actions
-    // The purpose of this is so they don't show up in the UI and can't be
-    // modified, since the attached device isn't inserted so modifying them
-    // wouldn't be possible anyway and they shouldn't get accidentally reset
-    // if other binds are reset
-    for (auto& [bind, actions] : m_binds) {
-        if (bind.bind->getDeviceID() != device) {
-            continue;
-        }
-        for (auto& action : actions) {
-            // Bind::save may fail
-            try {
-                m_devicelessBinds[device][action].insert(this->saveBind(bind.bind));
-            }
-            catch(...) {}
-            this->removeBindFrom(action, bind.bind);
-        }
-    }
-    m_devices.erase(device);
-    DeviceEvent(device, false).post();
-}
-
-matjson::Value BindManager::saveBind(Bind* bind) const {
-    try {
-        auto json = bind->save();
-        json["device"] = bind->getDeviceID();
-        return json;
-    }
-    catch(...) {
-        return {};
-    }
-}
-
-Bind* BindManager::loadBind(matjson::Value const& json) const {
-    try {
-        auto device = json["device"].as_string();
-        if (!m_devices.contains(device)) {
-            return nullptr;
-        }
-        return m_devices.at(device)(json);
-    }
-    catch(...) {
-        return nullptr;
-    }
-}
-
-bool BindManager::loadActionBinds(ActionID const& action) {
-    try {
-        auto value = Mod::get()->template getSavedValue<matjson::Object>(action);
-        for (auto bind : value["binds"].as_array()) {
-            // try directly parsing the bind from a string if the device it's for
-            // is already connected
-            if (auto b = this->loadBind(bind)) {
-                this->addBindTo(action, b);
-            }
-            // otherwise save the bind's data for until the device is connected
-            // or the game is closed
-            else {
-                // if device ID exists, then add this to the list of unbound
-                // binds
-                if (bind.contains("device")) {
-                    try {
-                        m_devicelessBinds[bind["device"].as_string()][action].insert(bind);
-                    }
-                    catch(...) {}
-                }
-                // otherwise invalid bind save data
-            }
-        }
-        // load repeat options
-        if (value.contains("repeat")) {
-            auto rep = value["repeat"].as_object();
-            auto opts = RepeatOptions();
-            opts.enabled = rep["enabled"].as_bool();
-            opts.rate = rep["rate"].as_int();
-            opts.delay = rep["delay"].as_int();
-            this->setRepeatOptionsFor(action, opts);
-        }
-        return true;
-    }
-    catch(...) {
-        return false;
-    }
-}
-
-void BindManager::saveActionBinds(ActionID const& action) {
-    auto obj = matjson::Object();
-    auto binds = matjson::Array();
-    for (auto& bind : this->getBindsFor(action)) {
-        binds.push_back(this->saveBind(bind));
-    }
-    for (auto& [device, actions] : m_devicelessBinds) {
-        if (actions.contains(action)) {
-            for (auto& bind : actions.at(action)) {
-                binds.push_back(bind);
-            }
-        }
-    }
-    obj["binds"] = binds;
-    if (auto opts = this->getRepeatOptionsFor(action)) {
-        auto rep = matjson::Object();
-        rep["enabled"] = opts.value().enabled;
-        rep["rate"] = opts.value().rate;
-        rep["delay"] = opts.value().delay;
-        obj["repeat"] = rep;
-    }
-    Mod::get()->setSavedValue(action, obj);
-}
-
-bool BindManager::registerBindable(BindableAction const& action, ActionID const& after) {
-    this->stopAllRepeats();
-    if (ranges::contains(m_actions, [&](auto const& act) { return act.first == action.getID(); })) {
-        return false;
-    }
-    if (auto ix = ranges::indexOf(m_actions, [&](auto const& a) { return a.first == after; })) {
-        m_actions.insert(m_actions.begin() + ix.value() + 1, {
-            action.getID(),
-            { .definition = action, .repeat = RepeatOptions() }
-        });
-    }
-    else {
-        m_actions.push_back({
-            action.getID(),
-            { .definition = action, .repeat = RepeatOptions() }
-        });
-    }
-    this->addCategory(action.getCategory());
-    if (!this->loadActionBinds(action.getID())) {
-        for (auto& def : action.getDefaults()) {
-            this->addBindTo(action.getID(), def);
-        }
-    }
-    return true;
-}
-
-void BindManager::removeBindable(ActionID const& action) {
-    this->stopAllRepeats();
-    this->removeAllBindsFrom(action);
-    ranges::remove(m_actions, [&](auto const& act) { return act.first == action; });
-}
-
-std::optional<BindableAction> BindManager::getBindable(ActionID const& action) const {
-    for (auto& [id, bindable] : m_actions) {
-        if (id == action) {
-            return bindable.definition;
-        }
-    }
-    return std::nullopt;
-}
-
-std::vector<BindableAction> BindManager::getAllBindables() const {
-    std::vector<BindableAction> res;
-    for (auto& [_, action] : m_actions) {
-        res.push_back(action.definition);
-    }
-    return res;
-}
-
-std::vector<BindableAction> BindManager::getBindablesIn(Category const& category, bool sub) const {
-    std::vector<BindableAction> res;
-    for (auto& [_, action] : m_actions) {
-        if (sub ?
-            action.definition.getCategory().hasParent(category) :
-            (action.definition.getCategory() == category)
-        ) {
-            res.push_back(action.definition);
-        }
-    }
-    return res;
-}
-
-std::vector<BindableAction> BindManager::getBindablesFor(Bind* bind) const {
-    std::vector<BindableAction> res {};
-    if (m_binds.count(bind)) {
-        for (auto& bindable : m_binds.at(bind)) {
-            if (auto action = this->getBindable(bindable)) {
-                res.push_back(action.value());
-            }
-        }
-    }
-    return res;
-}
-
-std::vector<Category> BindManager::getAllCategories() const {
-    return m_categories;
-}
-
-void BindManager::addCategory(Category const& category) {
-    this->stopAllRepeats();
-    if (!ranges::contains(m_categories, category)) {
-        // Add parent categories first if they don't exist yet
-        if (auto parent = category.getParent()) {
-            this->addCategory(parent.value());
-        }
-        auto it = m_categories.begin();
-        bool foundParent = false;
-        for (auto& cat : m_categories) {
-            if (cat.hasParent(category)) {
-                foundParent = true;
-            }
-            else if (foundParent) {
-                break;
-            }
-            it++;
-        }
-        m_categories.insert(it, category);
-    }
-}
-
-void BindManager::removeCategory(Category const& category) {
-    this->stopAllRepeats();
-    for (auto& bindable : this->getBindablesIn(category, true)) {
-        this->removeBindable(bindable.getID());
-    }
-    ranges::remove(m_categories, [&](auto const& cat) { return cat.hasParent(category); });
-}
-
-void BindManager::addBindTo(ActionID const& action, Bind* bind) {
-    this->stopAllRepeats();
-    if (m_devices.contains(bind->getDeviceID())) {
-        m_binds[bind].push_back(action);
-    }
-    else {
-        m_devicelessBinds[bind->getDeviceID()][action].insert(this->saveBind(bind));
-    }
-}
-
-void BindManager::removeBindFrom(ActionID const& action, Bind* bind) {
-    this->stopAllRepeats();
-    ranges::remove(m_binds[bind], action);
-    if (m_binds.at(bind).empty()) {
-        m_binds.erase(bind);
-    }
-}
-
-void BindManager::removeAllBindsFrom(ActionID const& action) {
-    this->stopAllRepeats();
-    for (auto& [bind, actions] : m_binds) {
-        ranges::remove(actions, action);
-    }
-}
-
-std::vector<Ref<Bind>> BindManager::getBindsFor(ActionID const& action) const {
-    std::vector<Ref<Bind>> binds;
-    for (auto& [bind, actions] : m_binds) {
-        if (ranges::contains(actions, action)) {
-            binds.push_back(bind.bind);
-        }
-    }
-    return binds;
-}
-
-void BindManager::resetBindsToDefault(ActionID const& action) {
-    this->stopAllRepeats();
-    this->removeAllBindsFrom(action);
-    if (auto bindable = this->getBindable(action)) {
-        if (auto repeat = this->getRepeatOptionsFor(action)) {
-            this->setRepeatOptionsFor(action, RepeatOptions());
-        }
-        for (auto& def : bindable->getDefaults()) {
-            this->addBindTo(action, def);
-        }
-    }
-}
-
-bool BindManager::hasDefaultBinds(ActionID const& action) const {
-    if (auto bindable = this->getBindable(action)) {
-        auto binds = this->getBindsFor(action);
-        auto defs = bindable->getDefaults();
-        ranges::remove(defs, [=](auto const& def) {
-            return !m_devices.contains(def->getDeviceID());
-        });
-        if (binds.size() == defs.size()) {
-            for (size_t i = 0; i < binds.size(); i++) {
-                if (!binds.at(i)->isEqual(defs.at(i))) {
-                    return false;
-                }
-            }
-            return true;
-        }
-    }
-    return false;
-}
-
-std::optional<RepeatOptions> BindManager::getRepeatOptionsFor(ActionID const& action) {
-    for (auto& [id, bindable] : m_actions) {
-        if (id == action) {
-            if (bindable.definition.isRepeatable()) {
-                return bindable.repeat;
-            }
-        }
-    }
-    return std::nullopt;
-}
-
-void BindManager::setRepeatOptionsFor(ActionID const& action, RepeatOptions const& options) {
-    this->stopAllRepeats();
-    for (auto& [id, bindable] : m_actions) {
-        if (id == action) {
-            bindable.repeat = options;
-        }
-    }
-}
-
-ListenerResult BindManager::onDispatch(PressBindEvent* event) {
-    if (m_binds.contains(event->getBind())) {
-        for (auto& action : m_binds.at(event->getBind())) {
-            bool inserted = false;
-            if (event->isDown()) {
-                if (!m_held.contains(action)) {
-                    m_held.insert(action);
-                    inserted = true;
-                }
-                if (auto options = this->getRepeatOptionsFor(action)) {
-                    if (options.value().enabled && ranges::contains(m_repeating, [=](auto const& p) { return p.first == action; })) {
-                        return ListenerResult::Stop;
-                    }
-                }
-                this->repeat(action);
-            }
-            else {
-                m_held.erase(action);
-                this->unrepeat(action);
-            }
-            auto options = this->getRepeatOptionsFor(action);
-            if ((!options.has_value() || !options.value().enabled) && !inserted && m_held.contains(action)) {
-                return ListenerResult::Stop;
-            }
-            if (InvokeBindEvent(action, event->isDown()).post() == ListenerResult::Stop) {
-                return ListenerResult::Stop;
-            }
-        }
-    }
-    return ListenerResult::Propagate;
-}
-
-void BindManager::stopAllRepeats() {
-    m_repeating.clear();
-    CCScheduler::get()->unscheduleSelector(
-        schedule_selector(BindManager::onRepeat), this
-    );
-}
-
-void BindManager::unrepeat(ActionID const& action) {
-    ranges::remove(m_repeating, [=](auto const& p) { return p.first == action; });
-}
-
-void BindManager::repeat(ActionID const& action) {
-    // this is why you are supposed to pimpl stuff now i cant change the return type
-    if (auto options = this->getRepeatOptionsFor(action)) {
-        if (options.value().enabled) {
-            m_repeating.emplace_back(action, options.value().delay / 1000.f);
-            CCScheduler::get()->scheduleSelector(
-                schedule_selector(BindManager::onRepeat), this,
-                0.f, false
-            );
-        }
-    }
-}
-
-void BindManager::onRepeat(float dt) {
-    for (auto& [id, last] : m_repeating) {
-        if (auto options = this->getRepeatOptionsFor(id)) {
-            last -= dt;
-            if (last < 0.f) {
-                InvokeBindEvent(id, true).post();
-                last += options.value().rate / 1000.f;
-            }
-        }
-    }
-}
-
-void BindManager::save() {
-    for (auto& bindable : BindManager::get()->getAllBindables()) {
-        BindManager::get()->saveActionBinds(bindable.getID());
-    }
-}
-
-$on_mod(DataSaved) {
-    BindManager::get()->save();
-}
+#include "../include/Keybinds.hpp"
+#include "Geode/cocos/robtop/keyboard_dispatcher/CCKeyboardDelegate.h"
+#include "Geode/cocos/sprite_nodes/CCSprite.h"
+#include "Geode/loader/Event.hpp"
+#include <Geode/utils/ranges.hpp>
+#include <Geode/utils/string.hpp>
+#include <Geode/loader/ModEvent.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#ifdef GEODE_IS_WINDOWS
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <Geode/utils/file.hpp>
+#include <GUI/CCControlExtension/CCScale9Sprite.h>
+
+using namespace geode::prelude;
+using namespace keybinds;
+
+Modifier keybinds::operator|=(Modifier& a, Modifier const& b) {
+    return static_cast<Modifier>(reinterpret_cast<int&>(a) |= static_cast<int>(b));
+}
+
+bool keybinds::operator&(Modifier const& a, Modifier const& b) {
+    return static_cast<bool>(static_cast<int>(a) & static_cast<int>(b));
+}
+
+std::string keybinds::keyToString(enumKeyCodes key) {
+    switch (key) {
+        case KEY_None:      return "";
+        case KEY_C:         return "C";
+        case KEY_Multiply:  return "Mul";
+        case KEY_Divide:    return "Div";
+        case KEY_OEMPlus:   return "Plus";
+        case KEY_OEMMinus:  return "Minus";
+        case CONTROLLER_LTHUMBSTICK_DOWN: return "L_THUMBSTICK_DOWN";
+        case CONTROLLER_LTHUMBSTICK_LEFT: return "L_THUMBSTICK_LEFT";
+        case CONTROLLER_LTHUMBSTICK_UP: return "L_THUMBSTICK_UP";
+        case CONTROLLER_LTHUMBSTICK_RIGHT: return "L_THUMBSTICK_RIGHT";
+        case CONTROLLER_RTHUMBSTICK_RIGHT: return "R_THUMBSTICK_RIGHT";
+        case CONTROLLER_RTHUMBSTICK_LEFT: return "L_THUMBSTICK_RIGHT";
+        case CONTROLLER_RTHUMBSTICK_DOWN: return "L_THUMBSTICK_DOWN";
+        case CONTROLLER_RTHUMBSTICK_UP: return "L_THUMBSTICK_UP";
+        case static_cast<enumKeyCodes>(-1): return "Unk";
+        default: return CCKeyboardDispatcher::get()->keyToString(key);
+    }
+}
+
+bool keybinds::keyIsModifier(enumKeyCodes key) {
+    return
+        key == KEY_Control ||
+        key == KEY_LeftControl ||
+        key == KEY_RightContol ||
+        key == KEY_Shift ||
+        key == KEY_LeftShift ||
+        key == KEY_RightShift ||
+        key == KEY_Alt ||
+        key == KEY_LeftWindowsKey ||
+        key == KEY_RightWindowsKey;
+}
+
+bool keybinds::keyIsController(enumKeyCodes key) {
+    return key >= CONTROLLER_A && key <= CONTROLLER_RTHUMBSTICK_RIGHT;
+}
+
+std::optional<BindKey> keybinds::parseBindKey(std::string_view expr) {
+    // the lowercased names of every key and button the dispatcher has a
+    // name for. Names shared by several codes go to the first of them
+    static auto const keys = [] {
+        std::unordered_map<std::string, enumKeyCodes> keys;
+        for (int code = KEY_None + 1; code <= CONTROLLER_RTHUMBSTICK_RIGHT; code++) {
+            auto key = static_cast<enumKeyCodes>(code);
+            if (!CCKeyboardDispatcher::get()->keyToString(key)) {
+                continue;
+            }
+            keys.insert({ string::toLower(keyToString(key)), key });
+        }
+        return keys;
+    }();
+
+    auto parts = string::split(std::string(expr), "+");
+    if (parts.empty()) {
+        return std::nullopt;
+    }
+    auto modifiers = Modifier::None;
+    for (size_t i = 0; i + 1 < parts.size(); i++) {
+        auto part = string::toLower(string::trim(parts.at(i)));
+        if (part == "ctrl" || part == "control") {
+            modifiers |= Modifier::Control;
+        }
+        else if (part == "cmd" || part == "command") {
+            modifiers |= Modifier::Command;
+        }
+        else if (part == "shift") {
+            modifiers |= Modifier::Shift;
+        }
+        else if (part == "alt") {
+            modifiers |= Modifier::Alt;
+        }
+        else {
+            return std::nullopt;
+        }
+    }
+    auto found = keys.find(string::toLower(string::trim(parts.back())));
+    if (found == keys.end()) {
+        return std::nullopt;
+    }
+    if (keyIsController(found->second)) {
+        // controller binds don't have modifiers
+        if (modifiers != Modifier::None) {
+            return std::nullopt;
+        }
+        return BindKey::controller(found->second);
+    }
+    return BindKey::keyboard(found->second, modifiers);
+}
+
+bool Bind::isEqual(Bind* other) const {
+    return this->getHash() == other->getHash();
+}
+
+CCNode* Bind::createLabel() const {
+    return CCLabelBMFont::create(this->toString().c_str(), "goldFont.fnt");
+}
+
+CCNodeRGBA* Bind::createBindSprite() const {
+    auto bg = CCScale9Sprite::create("square.png"_spr);
+    bg->setOpacity(85);
+    bg->setColor({ 0, 0, 0 });
+    bg->setScale(.45f);
+
+    auto top = this->createLabel();
+    limitNodeSize(top, { 125.f, 30.f }, 1.f, .1f);
+    bg->setContentSize({
+        clamp(top->getScaledContentSize().width + 18.f, 18.f / bg->getScale(), 145.f),
+        18.f / bg->getScale()
+    });
+    bg->addChild(top);
+
+    top->setPosition(bg->getContentSize() / 2);
+
+    return bg;
+}
+
+Keybind* Keybind::create(enumKeyCodes key, Modifier modifiers) {
+    if (key == KEY_None || key == KEY_Unknown || keyIsController(key)) {
+        return nullptr;
+    }
+    auto ret = new Keybind();
+    ret->m_key = key;
+    ret->m_modifiers = modifiers;
+    ret->autorelease();
+    return ret;
+}
+
+Keybind* Keybind::parse(matjson::Value const& value) {
+    return Keybind::create(
+        static_cast<enumKeyCodes>(value["key"].as_int()),
+        static_cast<Modifier>(value["modifiers"].as_int())
+    );
+}
+
+matjson::Value Keybind::save() const {
+    return matjson::Object {
+        { "key", static_cast<int>(m_key) },
+        { "modifiers", static_cast<int>(m_modifiers) }
+    };
+}
+
+enumKeyCodes Keybind::getKey() const {
+    return m_key;
+}
+
+Modifier Keybind::getModifiers() const {
+    return m_modifiers;
+}
+
+size_t Keybind::getHash() const {
+    return std::hash<BindKey>()(BindKey::keyboard(m_key, m_modifiers));
+}
+
+bool Keybind::isEqual(Bind* other) const {
+    if (auto o = typeinfo_cast<Keybind*>(other)) {
+        return m_key == o->m_key && m_modifiers == o->m_modifiers;
+    }
+    return false;
+}
+
+std::string Keybind::toString() const {
+    std::string res = "";
+    if (m_modifiers & Modifier::Control) {
+        res += "Ctrl + ";
+    }
+    if (m_modifiers & Modifier::Command) {
+        res += "Cmd + ";
+    }
+    if (m_modifiers & Modifier::Shift) {
+        res += "Shift + ";
+    }
+    if (m_modifiers & Modifier::Alt) {
+        res += "Alt + ";
+    }
+    res += keyToString(m_key);
+    return res;
+}
+
+std::string Keybind::getDeviceID() const {
+    return "keyboard"_spr;
+}
+
+ControllerBind* ControllerBind::create(enumKeyCodes button) {
+    if (!keyIsController(button)) {
+        return nullptr;
+    }
+    auto ret = new ControllerBind();
+    ret->m_button = button;
+    ret->autorelease();
+    return ret;
+}
+
+ControllerBind* ControllerBind::parse(matjson::Value const& value) {
+    return ControllerBind::create(
+        static_cast<enumKeyCodes>(value["button"].as_double())
+    );
+}
+
+matjson::Value ControllerBind::save() const {
+    return matjson::Object {
+        { "button", static_cast<int>(m_button) },
+    };
+}
+
+enumKeyCodes ControllerBind::getButton() const {
+    return m_button;
+}
+
+size_t ControllerBind::getHash() const {
+    return std::hash<BindKey>()(BindKey::controller(m_button));
+}
+
+bool ControllerBind::isEqual(Bind* other) const {
+    if (auto o = typeinfo_cast<ControllerBind*>(other)) {
+        return m_button == o->m_button;
+    }
+    return false;
+}
+
+std::string ControllerBind::toString() const {
+    return keyToString(m_button);
+}
+
+CCNode* ControllerBind::createLabel() const {
+    const char* sprite;
+    switch (m_button) {
+        case CONTROLLER_A: sprite = "controllerBtn_A_001.png"; break;
+        case CONTROLLER_B: sprite = "controllerBtn_B_001.png"; break;
+        case CONTROLLER_X: sprite = "controllerBtn_X_001.png"; break;
+        case CONTROLLER_Y: sprite = "controllerBtn_Y_001.png"; break;
+        case CONTROLLER_Back: sprite = "controllerBtn_Back_001.png"; break;
+        case CONTROLLER_Start: sprite = "controllerBtn_Start_001.png"; break;
+        case CONTROLLER_Down: sprite = "controllerBtn_DPad_Down_001.png"; break;
+        case CONTROLLER_Left: sprite = "controllerBtn_DPad_Left_001.png"; break;
+        case CONTROLLER_Up: sprite = "controllerBtn_DPad_Up_001.png"; break;
+        case CONTROLLER_Right: sprite = "controllerBtn_DPad_Right_001.png"; break;
+        case CONTROLLER_LT: sprite = "controllerBtn_LT_001.png"_spr; break;
+        case CONTROLLER_RT: sprite = "controllerBtn_RT_001.png"_spr; break;
+        // todo: are these the same
+        case CONTROLLER_LB: sprite = "controllerBtn_LB_001.png"_spr; break;
+        case CONTROLLER_RB: sprite = "controllerBtn_RB_001.png"_spr; break;
+        case CONTROLLER_LTHUMBSTICK_DOWN: sprite = "controllerBtn_LThumb_001.png"; break;
+        case CONTROLLER_LTHUMBSTICK_LEFT: sprite = "controllerBtn_LThumb_001.png"; break;
+        case CONTROLLER_LTHUMBSTICK_RIGHT: sprite = "controllerBtn_LThumb_001.png"; break;
+        case CONTROLLER_LTHUMBSTICK_UP: sprite = "controllerBtn_LThumb_001.png"; break;
+        case CONTROLLER_RTHUMBSTICK_RIGHT: sprite = "controllerBtn_RThumb_001.png"; break;
+        case CONTROLLER_RTHUMBSTICK_DOWN: sprite = "controllerBtn_RThumb_001.png"; break;
+        case CONTROLLER_RTHUMBSTICK_LEFT: sprite = "controllerBtn_RThumb_001.png"; break;
+        case CONTROLLER_RTHUMBSTICK_UP: sprite = "controllerBtn_RThumb_001.png"; break;
+        default: sprite = nullptr;
+    }
+    if (!sprite) {
+        return CCLabelBMFont::create("Unk", "goldFont.fnt");
+    }
+    auto spr = CCSprite::createWithSpriteFrameName(sprite);
+    switch (m_button) {
+        case CONTROLLER_LTHUMBSTICK_DOWN:
+        case CONTROLLER_RTHUMBSTICK_DOWN: {
+            auto arrow = CCSprite::createWithSpriteFrameName("PBtn_Arrow_001.png");
+            arrow->setPosition(ccp(13.f, -5.5f));
+            arrow->setScale(0.7f);
+            spr->addChild(arrow);
+            break;
+        }
+        case CONTROLLER_LTHUMBSTICK_LEFT:
+        case CONTROLLER_RTHUMBSTICK_LEFT: {
+            auto arrow = CCSprite::createWithSpriteFrameName("PBtn_Arrow_001.png");
+            arrow->setPosition(ccp(-5.5f, 13.5f));
+            arrow->setScale(0.7f);
+            arrow->setRotation(90.f);
+            spr->addChild(arrow);
+            break;
+        }
+        case CONTROLLER_LTHUMBSTICK_RIGHT:
+        case CONTROLLER_RTHUMBSTICK_RIGHT: {
+            auto arrow = CCSprite::createWithSpriteFrameName("PBtn_Arrow_001.png");
+            arrow->setPosition(ccp(31.5f, 13.f));
+            arrow->setScale(0.7f);
+            arrow->setRotation(270.f);
+            spr->addChild(arrow);
+            break;
+        }
+        case CONTROLLER_LTHUMBSTICK_UP:
+        case CONTROLLER_RTHUMBSTICK_UP: {
+            auto arrow = CCSprite::createWithSpriteFrameName("PBtn_Arrow_001.png");
+            arrow->setPosition(ccp(13.f, 31.f));
+            arrow->setScale(0.7f);
+            arrow->setRotation(180.f);
+            spr->addChild(arrow);
+            break;
+        }
+
+        default: {}
+    }
+    return spr;
+}
+
+std::string ControllerBind::getDeviceID() const {
+    return "controller"_spr;
+}
+
+BindHash::BindHash(Bind* bind) : bind(bind), key(BindManager::get()->getKeyFor(bind)) {}
+
+BindHash::BindHash(BindKey key) : bind(nullptr), key(key) {}
+
+bool BindHash::operator==(BindHash const& other) const {
+    // binds from built-in devices always have a key and others never do
+    if (key || other.key) {
+        return key == other.key;
+    }
+    return bind->isEqual(other.bind);
+}
+
+std::size_t std::hash<keybinds::BindHash>::operator()(keybinds::BindHash const& hash) const {
+    if (hash.key) {
+        return std::hash<BindKey>()(hash.key);
+    }
+    if (!hash.bind) {
+        return 0;
+    }
+    auto res = hash.bind->getHash();
+    res ^= std::hash<std::string>()(hash.bind->getDeviceID()) + 0x9e3779b9 + (res << 6) + (res >> 2);
+    return res;
+}
+
+Category::Category(const char* path) : m_value(path) {}
+
+Category::Category(std::string const& path) : m_value(path) {}
+
+std::vector<std::string> Category::getPath() const {
+    return string::split(m_value, "/");
+}
+
+std::optional<Category> Category::getParent() const {
+    if (string::contains(m_value, '/')) {
+        return Category(m_value.substr(0, m_value.find_last_of('/')));
+    }
+    return std::nullopt;
+}
+
+bool Category::hasParent(Category const& parent) const {
+    return m_value.starts_with(parent.m_value);
+}
+
+std::string Category::toString() const {
+    return m_value;
+}
+
+bool Category::operator==(Category const& other) const {
+    return m_value == other.m_value;
+}
+
+std::string BindableAction::getID() const {
+    return m_id;
+}
+
+std::string BindableAction::getName() const {
+    return m_name.empty() ? m_id : m_name;
+}
+
+std::string BindableAction::getDescription() const {
+    return m_description;
+}
+
+Mod* BindableAction::getMod() const {
+    return m_owner;
+}
+
+std::vector<Ref<Bind>> BindableAction::getDefaults() const {
+    auto defaults = m_defaults;
+    for (auto key : m_defaultKeys) {
+        if (auto bind = BindManager::get()->createBind(key)) {
+            defaults.push_back(bind);
+        }
+    }
+    return defaults;
+}
+
+Category BindableAction::getCategory() const {
+    return m_category;
+}
+
+bool BindableAction::isRepeatable() const {
+    return m_repeatable;
+}
+
+BindableAction::BindableAction(
+    ActionID const& id,
+    std::string const& name,
+    std::string const& description,
+    std::vector<Ref<Bind>> const& defaults,
+    Category const& category,
+    bool repeatable,
+    Mod* owner
+) : m_id(id),
+    m_owner(owner),
+    m_name(name),
+    m_description(description),
+    m_category(category),
+    m_repeatable(repeatable),
+    m_defaults(defaults) {}
+
+BindableAction::BindableAction(BindableDescriptor const& descriptor, Mod* owner)
+  : m_id(descriptor.id),
+    m_owner(owner),
+    m_name(descriptor.name),
+    m_description(descriptor.description),
+    m_category(descriptor.category),
+    m_repeatable(descriptor.repeatable)
+{
+    for (auto key : descriptor.defaults) {
+        if (key) {
+            m_defaultKeys.push_back(key);
+        }
+    }
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+        return ns;
+    }
+    // the first 5 bits after the highest set bit pick the sub-bucket
+    size_t exponent = std::bit_width(ns) - 1;
+    if (exponent >= MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+    auto sub = (ns >> (exponent - 5)) & (SUB_BUCKETS - 1);
+    return (exponent - 4) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::highestValueIn(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t exponent = bucket / SUB_BUCKETS + 4;
+    uint64_t sub = bucket % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << (exponent - 5)) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    auto ns = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+    m_counts[bucketOf(ns)] += 1;
+    m_count += 1;
+    m_total += ns;
+    m_min = std::min(m_min, ns);
+    m_max = std::max(m_max, ns);
+}
+
+void LatencyHistogram::reset() {
+    *this = LatencyHistogram();
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return m_count;
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMin() const {
+    return std::chrono::nanoseconds(m_count ? m_min : 0);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMax() const {
+    return std::chrono::nanoseconds(m_max);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMean() const {
+    return std::chrono::nanoseconds(m_count ? m_total / m_count : 0);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getPercentile(double percentile) const {
+    if (!m_count) {
+        return std::chrono::nanoseconds(0);
+    }
+    auto target = static_cast<uint64_t>(std::ceil(m_count * std::clamp(percentile, 0.0, 100.0) / 100.0));
+    target = std::max<uint64_t>(target, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+        seen += m_counts[i];
+        if (seen >= target) {
+            return std::chrono::nanoseconds(std::min(highestValueIn(i), m_max));
+        }
+    }
+    return std::chrono::nanoseconds(m_max);
+}
+
+InvokeBindEvent::InvokeBindEvent(ActionID const& id, bool down)
+  : m_id(id), m_handle(BindManager::get()->findActionHandle(id)), m_down(down) {}
+
+InvokeBindEvent::InvokeBindEvent(ActionHandle handle, bool down)
+  : m_handle(handle), m_down(down) {}
+
+std::string InvokeBindEvent::getID() const {
+    // events invoked by handle only look up their ID if someone asks for it
+    if (m_id.empty()) {
+        return BindManager::get()->getActionID(m_handle);
+    }
+    return m_id;
+}
+
+ActionHandle InvokeBindEvent::getHandle() const {
+    return m_handle;
+}
+
+bool InvokeBindEvent::isDown() const {
+    return m_down;
+}
+
+std::optional<Timestamp> InvokeBindEvent::getTimestamp() const {
+    return m_timestamp;
+}
+
+void InvokeBindEvent::setTimestamp(std::optional<Timestamp> timestamp) {
+    m_timestamp = timestamp;
+}
+
+ListenerResult InvokeBindFilter::handle(utils::MiniFunction<Callback> fn, InvokeBindEvent* event) {
+    if (event->getHandle() == m_handle) {
+        return fn(event);
+    }
+    return ListenerResult::Propagate;
+}
+
+InvokeBindFilter::InvokeBindFilter(CCNode* target, ActionID const& id)
+  : InvokeBindFilter(target, BindManager::get()->getActionHandle(id)) {}
+
+InvokeBindFilter::InvokeBindFilter(CCNode* target, ActionHandle handle)
+  : m_target(target), m_id(BindManager::get()->getActionID(handle)), m_handle(handle) {
+    BindManager::get()->countLegacyFilter(m_handle, true);
+}
+
+InvokeBindFilter::InvokeBindFilter(InvokeBindFilter const& other)
+  : m_target(other.m_target), m_id(other.m_id), m_handle(other.m_handle) {
+    BindManager::get()->countLegacyFilter(m_handle, true);
+}
+
+InvokeBindFilter& InvokeBindFilter::operator=(InvokeBindFilter const& other) {
+    BindManager::get()->countLegacyFilter(other.m_handle, true);
+    BindManager::get()->countLegacyFilter(m_handle, false);
+    m_target = other.m_target;
+    m_id = other.m_id;
+    m_handle = other.m_handle;
+    return *this;
+}
+
+InvokeBindFilter::~InvokeBindFilter() {
+    BindManager::get()->countLegacyFilter(m_handle, false);
+}
+
+ActionListener::ActionListener(ActionHandle action, MiniFunction<Callback> callback)
+  : m_action(action), m_callback(callback) {}
+
+ActionListener* ActionListener::create(ActionHandle action, MiniFunction<Callback> callback) {
+    auto ret = new ActionListener(action, callback);
+    BindManager::get()->addListener(ret);
+    ret->autorelease();
+    return ret;
+}
+
+ActionListener* ActionListener::create(ActionID const& action, MiniFunction<Callback> callback) {
+    return ActionListener::create(BindManager::get()->getActionHandle(action), callback);
+}
+
+ActionListener::~ActionListener() {
+    BindManager::get()->removeListener(this);
+}
+
+ActionHandle ActionListener::getAction() const {
+    return m_action;
+}
+
+PressBindEvent::PressBindEvent(Bind* bind, bool down)
+  : m_bind(bind), m_key(BindManager::get()->getKeyFor(bind)), m_down(down) {}
+
+PressBindEvent::PressBindEvent(BindKey key, bool down)
+  : m_bind(nullptr), m_key(key), m_down(down) {}
+
+Bind* PressBindEvent::getBind() const {
+    if (!m_bind && m_key) {
+        m_bind = BindManager::get()->createBind(m_key);
+    }
+    return m_bind;
+}
+
+BindKey PressBindEvent::getKey() const {
+    return m_key;
+}
+
+bool PressBindEvent::isDown() const {
+    return m_down;
+}
+
+std::optional<Timestamp> PressBindEvent::getTimestamp() const {
+    return m_timestamp;
+}
+
+void PressBindEvent::setTimestamp(std::optional<Timestamp> timestamp) {
+    m_timestamp = timestamp;
+}
+
+geode::ListenerResult PressBindFilter::handle(MiniFunction<Callback> fn, PressBindEvent* event) {
+    return fn(event);
+}
+
+PressBindFilter::PressBindFilter() {}
+
+DeviceEvent::DeviceEvent(DeviceID const& id, bool attached)
+  : m_id(id), m_attached(attached) {}
+
+DeviceID DeviceEvent::getID() const {
+    return m_id;
+}
+
+bool DeviceEvent::wasAttached() const {
+    return m_attached;
+}
+
+bool DeviceEvent::wasDetached() const {
+    return !m_attached;
+}
+
+ListenerResult DeviceFilter::handle(MiniFunction<Callback> fn, DeviceEvent* event) {
+    if (!m_id || m_id == event->getID()) {
+        fn(event);
+    }
+    return ListenerResult::Propagate;
+}
+
+DeviceFilter::DeviceFilter(std::optional<DeviceID> id) : m_id(id) {}
+
+static std::filesystem::path getStorePath() {
+    return Mod::get()->getSaveDir() / "binds.bin";
+}
+
+static std::filesystem::path getJournalPath() {
+    return Mod::get()->getSaveDir() / "binds.journal";
+}
+
+BindManager::BindManager() {
+    // ordinal 0 is reserved for empty keys, and the built-in devices always
+    // get the same ordinals so BindKey can hardcode them
+    m_internedBinds.emplace_back();
+    this->registerDevice("keyboard"_spr);
+    this->registerDevice("controller"_spr);
+    this->addCategory(Category::GLOBAL);
+    this->addCategory(Category::PLAY);
+    this->addCategory(Category::EDITOR);
+    this->attachDevice("keyboard"_spr, &Keybind::parse);
+    m_useStore = Mod::get()->template getSettingValue<bool>("binary-bind-store");
+    if (m_useStore) {
+        this->readStore();
+    }
+    // the store and journal stop being updated, so they'd be out of date if
+    // the store was turned back on
+    else {
+        std::error_code ec;
+        std::filesystem::remove(getStorePath(), ec);
+        std::filesystem::remove(getJournalPath(), ec);
+    }
+    // the keys of the binds of actions that aren't loaded are found in
+    // the store
+    m_lazyLoading = m_useStore && Mod::get()->template getSettingValue<bool>("lazy-bind-loading");
+    this->retain();
+}
+
+BindManager* BindManager::get() {
+    static auto inst = new BindManager();
+    return inst;
+}
+
+uint16_t BindManager::registerDevice(DeviceID const& device) {
+    if (auto it = m_deviceOrdinals.find(device); it != m_deviceOrdinals.end()) {
+        return it->second;
+    }
+    auto ordinal = static_cast<uint16_t>(m_internedBinds.size());
+    m_deviceOrdinals.insert({ device, ordinal });
+    m_internedBinds.emplace_back();
+    return ordinal;
+}
+
+uint16_t BindManager::getDeviceOrdinal(DeviceID const& device) const {
+    if (auto it = m_deviceOrdinals.find(device); it != m_deviceOrdinals.end()) {
+        return it->second;
+    }
+    return 0;
+}
+
+void BindManager::attachDevice(DeviceID const& device, BindParser parser) {
+    if (m_devices.contains(device)) return;
+    this->registerDevice(device);
+    m_devices.insert({ device, parser });
+    for (auto& [action, binds] : m_devicelessBinds[device]) {
+        for (auto& data : binds) {
+            // parser may fail
+            try {
+                if (auto nbind = parser(data)) {
+                    this->addBindTo(action, nbind);
+                }
+            }
+            catch(...) {}
+        }
+    }
+    m_devicelessBinds.erase(device);
+    DeviceEvent(device, true).post();
+}
+
+void BindManager::detachDevice(DeviceID const& device) {
+    // Remove all binds related to this device from actions
+    // The purpose of this is so they don't show up in the UI and can't be
+    // modified, since the attached device isn't inserted so modifying them
+    // wouldn't be possible anyway and they shouldn't get accidentally reset
+    // if other binds are reset
+    auto ordinal = this->getDeviceOrdinal(device);
+    for (auto it = m_binds.begin(); it != m_binds.end();) {
+        if (it->first.getDevice() != ordinal) {
+            ++it;
+            continue;
+        }
+        auto bind = this->createBind(it->first);
+        for (auto& action : it->second) {
+            auto& data = m_actions.at(action.getValue());
+            // Bind::save may fail
+            try {
+                m_devicelessBinds[device][data.id].insert(this->saveBind(bind));
+            }
+            catch(...) {}
+            ranges::remove(data.binds, it->first);
+            this->release(action);
+        }
+        this->setKeyBound(it->first, false);
+        it = m_binds.erase(it);
+    }
+    m_devices.erase(device);
+    DeviceEvent(device, false).post();
+}
+
+matjson::Value BindManager::saveBind(Bind* bind) const {
+    try {
+        auto json = bind->save();
+        json["device"] = bind->getDeviceID();
+        return json;
+    }
+    catch(...) {
+        return {};
+    }
+}
+
+Bind* BindManager::loadBind(matjson::Value const& json) const {
+    try {
+        auto device = json["device"].as_string();
+        if (!m_devices.contains(device)) {
+            return nullptr;
+        }
+        return m_devices.at(device)(json);
+    }
+    catch(...) {
+        return nullptr;
+    }
+}
+
+BindKey BindManager::getKeyFor(Bind* bind) const {
+    if (!bind) {
+        return BindKey();
+    }
+    if (auto keybind = typeinfo_cast<Keybind*>(bind)) {
+        return BindKey::keyboard(keybind->getKey(), keybind->getModifiers());
+    }
+    if (auto controllerBind = typeinfo_cast<ControllerBind*>(bind)) {
+        return BindKey::controller(controllerBind->getButton());
+    }
+    // binds from other devices only have a key once they've been interned
+    // by being bound to something; this is only a lookup so that presses
+    // of unbound binds don't grow the table
+    auto ordinal = this->getDeviceOrdinal(bind->getDeviceID());
+    if (!ordinal) {
+        return BindKey();
+    }
+    auto& interned = m_internedBinds.at(ordinal);
+    auto [begin, end] = interned.byHash.equal_range(bind->getHash());
+    for (auto it = begin; it != end; ++it) {
+        if (interned.binds.at(it->second)->isEqual(bind)) {
+            return BindKey(ordinal, it->second);
+        }
+    }
+    return BindKey();
+}
+
+BindKey BindManager::internBind(Bind* bind) {
+    if (auto key = this->getKeyFor(bind)) {
+        return key;
+    }
+    auto ordinal = this->registerDevice(bind->getDeviceID());
+    auto& interned = m_internedBinds.at(ordinal);
+    auto code = static_cast<uint32_t>(interned.binds.size());
+    interned.binds.push_back(bind);
+    interned.byHash.insert({ bind->getHash(), code });
+    return BindKey(ordinal, code);
+}
+
+Bind* BindManager::createBind(BindKey key) const {
+    switch (key.getDevice()) {
+        case 0: return nullptr;
+        case BindKey::KEYBOARD: return Keybind::create(
+            static_cast<enumKeyCodes>(key.getCode()), key.getModifiers()
+        );
+        case BindKey::CONTROLLER: return ControllerBind::create(
+            static_cast<enumKeyCodes>(key.getCode())
+        );
+        default: {
+            if (key.getDevice() >= m_internedBinds.size()) {
+                return nullptr;
+            }
+            auto& interned = m_internedBinds.at(key.getDevice()).binds;
+            if (key.getCode() >= interned.size()) {
+                return nullptr;
+            }
+            return interned.at(key.getCode());
+        }
+    }
+}
+
+bool BindManager::loadActionBinds(ActionID const& action) {
+    if (this->loadStoredBinds(action)) {
+        return true;
+    }
+    try {
+        auto value = Mod::get()->template getSavedValue<matjson::Object>(action);
+        for (auto bind : value["binds"].as_array()) {
+            // try directly parsing the bind from a string if the device it's for
+            // is already connected
+            if (auto b = this->loadBind(bind)) {
+                this->addBindTo(action, b);
+            }
+            // otherwise save the bind's data for until the device is connected
+            // or the game is closed
+            else {
+                // if device ID exists, then add this to the list of unbound
+                // binds
+                if (bind.contains("device")) {
+                    try {
+                        m_devicelessBinds[bind["device"].as_string()][action].insert(bind);
+                    }
+                    catch(...) {}
+                }
+                // otherwise invalid bind save data
+            }
+        }
+        // load repeat options
+        if (value.contains("repeat")) {
+            auto rep = value["repeat"].as_object();
+            auto opts = RepeatOptions();
+            opts.enabled = rep["enabled"].as_bool();
+            opts.rate = rep["rate"].as_int();
+            opts.delay = rep["delay"].as_int();
+            this->setRepeatOptionsFor(action, opts);
+        }
+        return true;
+    }
+    catch(...) {
+        return false;
+    }
+}
+
+matjson::Array BindManager::getSavedBinds(ActionID const& action) const {
+    auto binds = matjson::Array();
+    for (auto& bind : this->getBindsFor(action)) {
+        binds.push_back(this->saveBind(bind));
+    }
+    for (auto& [device, actions] : m_devicelessBinds) {
+        if (actions.contains(action)) {
+            for (auto& bind : actions.at(action)) {
+                binds.push_back(bind);
+            }
+        }
+    }
+    return binds;
+}
+
+void BindManager::saveActionBinds(ActionID const& action) {
+    auto obj = matjson::Object();
+    obj["binds"] = this->getSavedBinds(action);
+    if (auto opts = this->getRepeatOptionsFor(action)) {
+        auto rep = matjson::Object();
+        rep["enabled"] = opts.value().enabled;
+        rep["rate"] = opts.value().rate;
+        rep["delay"] = opts.value().delay;
+        obj["repeat"] = rep;
+    }
+    Mod::get()->setSavedValue(action, obj);
+
+    if (m_useStore) {
+        m_store[action] = this->createStoredAction(action);
+    }
+}
+
+std::shared_ptr<BindManager::StoredAction const> BindManager::createStoredAction(ActionID const& action) {
+    auto stored = std::make_shared<StoredAction>();
+    for (auto& bind : this->getSavedBinds(action)) {
+        // keys of other devices are interned, so they don't stay the
+        // same between sessions
+        auto key = this->getKeyFor(this->loadBind(bind));
+        if (key.getDevice() == BindKey::KEYBOARD || key.getDevice() == BindKey::CONTROLLER) {
+            stored->keys.push_back(key);
+        }
+        else {
+            stored->custom.push_back(bind);
+        }
+    }
+    stored->repeat = this->getRepeatOptionsFor(action);
+    return stored;
+}
+
+// The binary bind store is a header, followed by a string table of action
+// IDs and then a record for each action. All integers are little-endian
+//
+// header:   char[4] magic, u16 version, u16 reserved, u32 generation,
+//           u32 last journal sequence number, u32 string count,
+//           u32 action count
+// string:   u32 length, char[length]
+// action:   u32 ID string index, record
+// record:   u8 has repeat, (if has repeat) u8 enabled, u32 rate, u32 delay,
+//           u32 key count, u64 BindKey[key count],
+//           u32 custom count, string[custom count] of bind JSON
+//
+// Edits made since the store was written are appended to the journal, which
+// is a header followed by an entry for each edit:
+//
+// header:   char[4] magic, u16 version, u16 reserved
+// entry:    u32 payload size, u32 FNV-1a hash of payload, payload
+// payload:  u32 sequence number, string action ID, record
+static constexpr std::array<char, 4> STORE_MAGIC { 'C', 'K', 'B', 'S' };
+static constexpr uint16_t STORE_VERSION = 2;
+static constexpr std::array<char, 4> JOURNAL_MAGIC { 'C', 'K', 'B', 'J' };
+static constexpr uint16_t JOURNAL_VERSION = 1;
+static constexpr size_t JOURNAL_HEADER_SIZE = 8;
+// the journal is compacted into the store once it grows past this
+static constexpr size_t JOURNAL_COMPACT_SIZE = 64 * 1024;
+
+class StoreReader final {
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+
+public:
+    StoreReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    template <class T>
+    bool read(T& out) {
+        if (m_size - m_pos < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&out, m_data + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+    }
+    bool read(std::string& out) {
+        uint32_t length;
+        if (!this->read(length) || m_size - m_pos < length) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(m_data + m_pos), length);
+        m_pos += length;
+        return true;
+    }
+};
+
+class StoreWriter final {
+    ByteVector m_data;
+
+public:
+    template <class T>
+    void write(T const& value) {
+        auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+    }
+    void write(std::string const& value) {
+        this->write(static_cast<uint32_t>(value.size()));
+        m_data.insert(m_data.end(), value.begin(), value.end());
+    }
+    void writeBytes(const uint8_t* data, size_t size) {
+        m_data.insert(m_data.end(), data, data + size);
+    }
+    ByteVector const& getData() const {
+        return m_data;
+    }
+};
+
+namespace keybinds {
+    // gives the store's serialization access to BindManager's records
+    struct StoreFormat {
+        using StoredAction = BindManager::StoredAction;
+
+        struct Snapshot {
+            std::filesystem::path path;
+            uint32_t generation;
+            uint32_t lastSeq;
+            std::vector<std::pair<ActionID, std::shared_ptr<StoredAction const>>> actions;
+        };
+    };
+}
+
+static void writeRecord(StoreWriter& writer, StoreFormat::StoredAction const& stored) {
+    writer.write(uint8_t(stored.repeat.has_value()));
+    if (stored.repeat) {
+        writer.write(uint8_t(stored.repeat->enabled));
+        writer.write(static_cast<uint32_t>(stored.repeat->rate));
+        writer.write(static_cast<uint32_t>(stored.repeat->delay));
+    }
+    writer.write(static_cast<uint32_t>(stored.keys.size()));
+    for (auto& key : stored.keys) {
+        writer.write(key.getValue());
+    }
+    writer.write(static_cast<uint32_t>(stored.custom.size()));
+    for (auto& json : stored.custom) {
+        writer.write(json.dump(matjson::NO_INDENTATION));
+    }
+}
+
+static bool readRecord(StoreReader& reader, StoreFormat::StoredAction& stored) {
+    uint8_t hasRepeat;
+    if (!reader.read(hasRepeat)) {
+        return false;
+    }
+    if (hasRepeat) {
+        uint8_t enabled;
+        uint32_t rate;
+        uint32_t delay;
+        if (!reader.read(enabled) || !reader.read(rate) || !reader.read(delay)) {
+            return false;
+        }
+        stored.repeat = RepeatOptions {
+            .enabled = enabled != 0,
+            .rate = rate,
+            .delay = delay,
+        };
+    }
+    uint32_t keyCount;
+    if (!reader.read(keyCount)) {
+        return false;
+    }
+    for (uint32_t k = 0; k < keyCount; k++) {
+        uint64_t key;
+        if (!reader.read(key)) {
+            return false;
+        }
+        stored.keys.push_back(BindKey(
+            static_cast<uint16_t>(key >> 48),
+            static_cast<uint32_t>(key),
+            static_cast<Modifier>((key >> 32) & 0xffff)
+        ));
+    }
+    uint32_t customCount;
+    if (!reader.read(customCount)) {
+        return false;
+    }
+    for (uint32_t c = 0; c < customCount; c++) {
+        std::string json;
+        if (!reader.read(json)) {
+            return false;
+        }
+        try {
+            stored.custom.push_back(matjson::Value::from_str(json));
+        }
+        catch(...) {}
+    }
+    return true;
+}
+
+static uint32_t hashBytes(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static FILE* openFile(std::filesystem::path const& path, const char* mode) {
+#ifdef GEODE_IS_WINDOWS
+    auto wideMode = std::wstring(mode, mode + std::strlen(mode));
+    return _wfopen(path.c_str(), wideMode.c_str());
+#else
+    return std::fopen(path.c_str(), mode);
+#endif
+}
+
+// Writes to a temporary file that is flushed to disk before it replaces the
+// target, so the file on disk is always either the old or the new one. The
+// rename is only durable once this returns true, so the journal mustn't be
+// compacted before that
+static bool writeFileAtomically(std::filesystem::path const& path, ByteVector const& data) {
+    auto temp = path;
+    temp += ".tmp";
+    FILE* file = openFile(temp, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = std::fflush(file) == 0 && ok;
+#ifdef GEODE_IS_WINDOWS
+    ok = _commit(_fileno(file)) == 0 && ok;
+#else
+    ok = fsync(fileno(file)) == 0 && ok;
+#endif
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, path, ec);
+    if (ec) {
+        return false;
+    }
+#ifndef GEODE_IS_WINDOWS
+    // the rename is an entry in the directory, which has to be flushed too,
+    // or a crash can bring back the old file
+    int dir = open(path.parent_path().c_str(), O_RDONLY);
+    if (dir < 0) {
+        return false;
+    }
+    ok = fsync(dir) == 0;
+    ok = close(dir) == 0 && ok;
+#endif
+    return ok;
+}
+
+struct JournalEntry {
+    uint32_t seq;
+    // the whole entry, including its size and hash
+    size_t offset;
+    size_t size;
+};
+
+// Get the intact entries of a journal. Reading stops at the first entry that
+// is cut off or doesn't match its hash, since that is where a crash happened
+static std::optional<std::vector<JournalEntry>> parseJournal(ByteVector const& data) {
+    auto reader = StoreReader(data.data(), data.size());
+    std::array<char, 4> magic;
+    uint16_t version;
+    uint16_t reserved;
+    if (
+        !reader.read(magic) || magic != JOURNAL_MAGIC ||
+        !reader.read(version) || version != JOURNAL_VERSION ||
+        !reader.read(reserved)
+    ) {
+        return std::nullopt;
+    }
+    std::vector<JournalEntry> entries;
+    size_t offset = JOURNAL_HEADER_SIZE;
+    while (data.size() - offset >= 8) {
+        uint32_t size;
+        uint32_t hash;
+        uint32_t seq;
+        std::memcpy(&size, data.data() + offset, sizeof(size));
+        std::memcpy(&hash, data.data() + offset + 4, sizeof(hash));
+        auto payload = data.data() + offset + 8;
+        if (data.size() - offset - 8 < size || size < sizeof(seq) || hashBytes(payload, size) != hash) {
+            break;
+        }
+        std::memcpy(&seq, payload, sizeof(seq));
+        entries.push_back({ seq, offset, size + 8 });
+        offset += size + 8;
+    }
+    return entries;
+}
+
+static ByteVector createJournalHeader() {
+    auto writer = StoreWriter();
+    writer.write(JOURNAL_MAGIC);
+    writer.write(JOURNAL_VERSION);
+    writer.write(uint16_t(0));
+    return writer.getData();
+}
+
+// The journal file is appended to on the main thread and compacted on the
+// store writer thread, so all access to it goes through this
+class BindJournal final {
+    std::mutex m_mutex;
+    std::filesystem::path m_path;
+    FILE* m_file = nullptr;
+    size_t m_size = 0;
+
+    void reopen() {
+        m_file = openFile(m_path, "ab");
+        std::error_code ec;
+        m_size = std::filesystem::file_size(m_path, ec);
+        if (ec) {
+            m_size = 0;
+        }
+    }
+
+public:
+    static BindJournal* get() {
+        static auto inst = new BindJournal();
+        return inst;
+    }
+
+    void open(std::filesystem::path const& path, ByteVector const& contents) {
+        std::lock_guard lock(m_mutex);
+        m_path = path;
+        (void)writeFileAtomically(m_path, contents);
+        this->reopen();
+    }
+
+    void append(ByteVector const& payload) {
+        std::lock_guard lock(m_mutex);
+        if (!m_file) {
+            return;
+        }
+        auto writer = StoreWriter();
+        writer.write(static_cast<uint32_t>(payload.size()));
+        writer.write(hashBytes(payload.data(), payload.size()));
+        writer.writeBytes(payload.data(), payload.size());
+        auto& entry = writer.getData();
+        // flushed so the entry survives the game crashing, but not synced
+        // to disk, so appending stays cheap
+        std::fwrite(entry.data(), 1, entry.size(), m_file);
+        std::fflush(m_file);
+        m_size += entry.size();
+    }
+
+    size_t getSize() {
+        std::lock_guard lock(m_mutex);
+        return m_size;
+    }
+
+    /**
+     * Drop the entries up to and including a sequence number, once the store
+     * containing them has been written
+     */
+    void compact(uint32_t seq) {
+        std::lock_guard lock(m_mutex);
+        if (!m_file) {
+            return;
+        }
+        std::fclose(m_file);
+        m_file = nullptr;
+        auto kept = createJournalHeader();
+        if (auto data = file::readBinary(m_path); data.isOk()) {
+            auto bytes = data.unwrap();
+            if (auto entries = parseJournal(bytes)) {
+                for (auto& entry : *entries) {
+                    if (entry.seq > seq) {
+                        kept.insert(
+                            kept.end(),
+                            bytes.begin() + entry.offset,
+                            bytes.begin() + entry.offset + entry.size
+                        );
+                    }
+                }
+            }
+        }
+        (void)writeFileAtomically(m_path, kept);
+        this->reopen();
+    }
+};
+
+void BindManager::readStore() {
+    // the JSON save data is the fallback, so it records how far along the
+    // store and journal were when it was last saved
+    auto savedGeneration = static_cast<uint32_t>(Mod::get()->template getSavedValue<int>("binary-store-generation"));
+    m_storeGeneration = savedGeneration;
+    m_journalSeq = static_cast<uint32_t>(Mod::get()->template getSavedValue<int>("journal-seq"));
+
+    auto data = file::readBinary(getStorePath());
+    if (data.isOk()) {
+        auto bytes = data.unwrap();
+        auto reader = StoreReader(bytes.data(), bytes.size());
+
+        std::array<char, 4> magic;
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t generation;
+        uint32_t lastSeq;
+        uint32_t stringCount;
+        uint32_t actionCount;
+        bool valid =
+            reader.read(magic) && magic == STORE_MAGIC &&
+            reader.read(version) && version == STORE_VERSION &&
+            reader.read(reserved) && reader.read(generation) &&
+            reader.read(lastSeq) &&
+            reader.read(stringCount) && reader.read(actionCount) &&
+            // every string and action takes at least 4 bytes
+            stringCount <= bytes.size() / 4 && actionCount <= bytes.size() / 4 &&
+            // the JSON save data is newer if the store couldn't be written
+            // the last time the game saved
+            generation >= savedGeneration;
+
+        std::vector<std::string> strings(valid ? stringCount : 0);
+        for (auto& string : strings) {
+            valid = valid && reader.read(string);
+        }
+        std::unordered_map<ActionID, std::shared_ptr<StoredAction const>> store;
+        for (uint32_t i = 0; valid && i < actionCount; i++) {
+            uint32_t id;
+            auto stored = std::make_shared<StoredAction>();
+            valid = reader.read(id) && id < strings.size() && readRecord(reader, *stored);
+            if (valid) {
+                store[strings[id]] = stored;
+            }
+        }
+        // only use the store if all of it could be read
+        if (valid) {
+            m_store = std::move(store);
+            m_storeGeneration = generation;
+            m_journalSeq = lastSeq;
+        }
+    }
+    this->replayJournal();
+}
+
+void BindManager::replayJournal() {
+    auto contents = createJournalHeader();
+    if (auto data = file::readBinary(getJournalPath()); data.isOk()) {
+        auto bytes = data.unwrap();
+        auto lastSeq = m_journalSeq;
+        for (auto& entry : parseJournal(bytes).value_or(std::vector<JournalEntry>())) {
+            // entries that are already in the store or JSON were kept
+            // because compacting was interrupted
+            if (entry.seq > lastSeq) {
+                auto reader = StoreReader(bytes.data() + entry.offset + 8, entry.size - 8);
+                uint32_t seq;
+                std::string id;
+                auto stored = std::make_shared<StoredAction>();
+                if (!reader.read(seq) || !reader.read(id) || !readRecord(reader, *stored)) {
+                    break;
+                }
+                m_store[id] = stored;
+                contents.insert(
+                    contents.end(),
+                    bytes.begin() + entry.offset,
+                    bytes.begin() + entry.offset + entry.size
+                );
+            }
+            m_journalSeq = std::max(m_journalSeq, entry.seq);
+        }
+    }
+    // rewritten so that a cut off entry at the end doesn't hide the entries
+    // appended after it
+    BindJournal::get()->open(getJournalPath(), contents);
+}
+
+void BindManager::queueJournal(ActionHandle action) {
+    auto& data = m_actions.at(action.getValue());
+    if (!m_useStore || data.journalPending) {
+        return;
+    }
+    data.journalPending = true;
+    m_journalQueue.push_back(action);
+    // edits are journaled on the next frame, so an edit that takes several
+    // changes like resetting an action to its defaults only makes one entry.
+    // A batch schedules the journal once when it ends
+    if (m_batchDepth == 0) {
+        this->scheduleJournal();
+    }
+}
+
+void BindManager::scheduleJournal() {
+    if (!m_journalScheduled) {
+        m_journalScheduled = true;
+        Loader::get()->queueInMainThread([this] {
+            this->flushJournal();
+        });
+    }
+}
+
+void BindManager::flushJournal() {
+    m_journalScheduled = false;
+    for (auto handle : m_journalQueue) {
+        auto& data = m_actions.at(handle.getValue());
+        if (!data.journalPending) {
+            continue;
+        }
+        data.journalPending = false;
+        if (!data.registered) {
+            continue;
+        }
+        auto stored = this->createStoredAction(data.id);
+        m_store[data.id] = stored;
+        m_journalSeq += 1;
+
+        auto payload = StoreWriter();
+        payload.write(m_journalSeq);
+        payload.write(data.id);
+        writeRecord(payload, *stored);
+        BindJournal::get()->append(payload.getData());
+    }
+    m_journalQueue.clear();
+
+    if (BindJournal::get()->getSize() > JOURNAL_COMPACT_SIZE) {
+        m_storeGeneration += 1;
+        this->writeStore();
+    }
+}
+
+using StoreSnapshot = StoreFormat::Snapshot;
+
+static ByteVector serializeStore(StoreSnapshot const& snapshot) {
+    auto writer = StoreWriter();
+    writer.write(STORE_MAGIC);
+    writer.write(STORE_VERSION);
+    writer.write(uint16_t(0));
+    writer.write(snapshot.generation);
+    writer.write(snapshot.lastSeq);
+    writer.write(static_cast<uint32_t>(snapshot.actions.size()));
+    writer.write(static_cast<uint32_t>(snapshot.actions.size()));
+    for (auto& [id, _] : snapshot.actions) {
+        writer.write(id);
+    }
+    uint32_t index = 0;
+    for (auto& [_, stored] : snapshot.actions) {
+        writer.write(index++);
+        writeRecord(writer, *stored);
+    }
+    return writer.getData();
+}
+
+// Writes snapshots of the store on a background thread so saving never
+// stalls a frame. If several saves happen while a write is in progress,
+// only the latest snapshot is written
+class StoreWriterThread final {
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::optional<StoreSnapshot> m_pending;
+
+    StoreWriterThread() {
+        // detached, since the game may exit with a write in progress. That
+        // leaves the old store and the journal in place
+        std::thread([this] { this->run(); }).detach();
+    }
+
+    void run() {
+        while (true) {
+            StoreSnapshot snapshot;
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_pending.has_value(); });
+                snapshot = std::move(*m_pending);
+                m_pending.reset();
+            }
+            if (writeFileAtomically(snapshot.path, serializeStore(snapshot))) {
+                BindJournal::get()->compact(snapshot.lastSeq);
+            }
+        }
+    }
+
+public:
+    static StoreWriterThread* get() {
+        static auto inst = new StoreWriterThread();
+        return inst;
+    }
+
+    void queue(StoreSnapshot&& snapshot) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_pending = std::move(snapshot);
+        }
+        m_condition.notify_one();
+    }
+};
+
+void BindManager::writeStore() const {
+    // only the pointers to the records are copied here, serializing them
+    // happens on the writer thread
+    auto snapshot = StoreSnapshot {
+        .path = getStorePath(),
+        .generation = m_storeGeneration,
+        .lastSeq = m_journalSeq,
+    };
+    snapshot.actions.reserve(m_store.size());
+    for (auto& entry : m_store) {
+        snapshot.actions.push_back(entry);
+    }
+    StoreWriterThread::get()->queue(std::move(snapshot));
+}
+
+bool BindManager::loadStoredBinds(ActionID const& action) {
+    auto found = m_store.find(action);
+    if (found == m_store.end()) {
+        return false;
+    }
+    // keep the record alive in case it's replaced while loading
+    auto stored = found->second;
+    auto handle = this->getActionHandle(action);
+    for (auto& key : stored->keys) {
+        if (key.getDevice() == BindKey::KEYBOARD || key.getDevice() == BindKey::CONTROLLER) {
+            this->bindOrDefer(handle, key);
+        }
+    }
+    for (auto& json : stored->custom) {
+        if (auto bind = this->loadBind(json)) {
+            this->addBindTo(action, bind);
+        }
+        else {
+            try {
+                m_devicelessBinds[json["device"].as_string()][action].insert(json);
+            }
+            catch(...) {}
+        }
+    }
+    if (stored->repeat) {
+        this->setRepeatOptionsFor(action, *stored->repeat);
+    }
+    return true;
+}
+
+ActionHandle BindManager::getActionHandle(ActionID const& action) {
+    auto [found, inserted] = m_actionHandles.insert({
+        action, ActionHandle(static_cast<uint32_t>(m_actions.size()))
+    });
+    if (inserted) {
+        m_actions.push_back({ .id = action });
+    }
+    return found->second;
+}
+
+ActionHandle BindManager::findActionHandle(ActionID const& action) const {
+    if (auto found = m_actionHandles.find(action); found != m_actionHandles.end()) {
+        return found->second;
+    }
+    return ActionHandle();
+}
+
+ActionID BindManager::getActionID(ActionHandle handle) const {
+    if (handle.getValue() < m_actions.size()) {
+        return m_actions.at(handle.getValue()).id;
+    }
+    return "";
+}
+
+BindManager::ActionData const* BindManager::findAction(ActionID const& action) const {
+    if (auto found = m_actionHandles.find(action); found != m_actionHandles.end()) {
+        return &m_actions.at(found->second.getValue());
+    }
+    return nullptr;
+}
+
+BindManager::ActionData* BindManager::getActionData(ActionHandle action) {
+    if (action.getValue() < m_actions.size()) {
+        auto& data = m_actions.at(action.getValue());
+        return data.registered ? &data : nullptr;
+    }
+    return nullptr;
+}
+
+BindManager::ActionData* BindManager::getActionData(ActionID const& action) {
+    auto data = const_cast<ActionData*>(this->findAction(action));
+    return data && data->registered ? data : nullptr;
+}
+
+BindManager::ActionData const* BindManager::getActionData(ActionID const& action) const {
+    return const_cast<BindManager*>(this)->getActionData(action);
+}
+
+bool BindManager::registerBindable(BindableAction const& action, ActionID const& after) {
+    return static_cast<bool>(this->registerBindables(std::span(&action, 1), after).front());
+}
+
+std::vector<ActionHandle> BindManager::registerBindables(
+    std::span<BindableAction const> actions, ActionID const& after
+) {
+    BindBatch batch;
+    std::vector<ActionHandle> handles;
+    handles.reserve(actions.size());
+    std::vector<ActionHandle> added;
+    added.reserve(actions.size());
+    for (auto& action : actions) {
+        auto handle = this->getActionHandle(action.getID());
+        auto& data = m_actions.at(handle.getValue());
+        if (data.registered) {
+            handles.push_back(ActionHandle());
+            continue;
+        }
+        data.definition = action;
+        data.repeat = RepeatOptions();
+        data.registered = true;
+        handles.push_back(handle);
+        added.push_back(handle);
+    }
+
+    // an action removed earlier in the batch may still be in the order
+    this->compactActionOrder();
+    auto pos = m_actionOrder.end();
+    if (this->getActionData(after)) {
+        // the action may be one of the ones just added
+        auto found = std::find(
+            m_actionOrder.begin(), m_actionOrder.end(),
+            m_actionHandles.at(after)
+        );
+        if (found != m_actionOrder.end()) {
+            pos = found + 1;
+        }
+    }
+    m_actionOrder.insert(pos, added.begin(), added.end());
+
+    // actions mostly come in runs that share a category
+    std::unordered_set<std::string> categories;
+    for (auto handle : added) {
+        auto category = m_actions.at(handle.getValue()).definition.getCategory();
+        if (categories.insert(category.toString()).second) {
+            this->addCategory(category);
+        }
+    }
+
+    for (auto handle : added) {
+        if (m_lazyLoading && this->deferLoad(handle)) {
+            continue;
+        }
+        this->loadBinds(handle);
+    }
+    return handles;
+}
+
+std::vector<ActionHandle> BindManager::registerBindables(
+    std::span<BindableDescriptor const> actions, ActionID const& after
+) {
+    std::vector<BindableAction> bindables;
+    bindables.reserve(actions.size());
+    for (auto& action : actions) {
+        bindables.emplace_back(action);
+    }
+    return this->registerBindables(std::span<BindableAction const>(bindables), after);
+}
+
+void BindManager::removeBindable(ActionID const& action) {
+    if (auto found = m_actionHandles.find(action); found != m_actionHandles.end()) {
+        this->takePending(found->second);
+    }
+    this->removeAllBindsFrom(action);
+    if (auto data = this->getActionData(action)) {
+        data->registered = false;
+        if (m_batchDepth > 0) {
+            m_actionOrderStale = true;
+        }
+        else {
+            ranges::remove(m_actionOrder, m_actionHandles.at(action));
+        }
+    }
+}
+
+void BindManager::countLegacyFilter(ActionHandle action, bool added) noexcept {
+    if (action.getValue() >= m_actions.size()) {
+        return;
+    }
+    auto& filters = m_actions[action.getValue()].legacyFilters;
+    if (added) {
+        filters += 1;
+    }
+    else if (filters > 0) {
+        filters -= 1;
+    }
+}
+
+void BindManager::compactActionOrder() {
+    if (m_actionOrderStale) {
+        m_actionOrderStale = false;
+        std::erase_if(m_actionOrder, [&](ActionHandle handle) {
+            return !m_actions.at(handle.getValue()).registered;
+        });
+    }
+}
+
+std::optional<BindableAction> BindManager::getBindable(ActionID const& action) const {
+    if (auto data = this->getActionData(action)) {
+        return data->definition;
+    }
+    return std::nullopt;
+}
+
+std::vector<BindableAction> BindManager::getAllBindables() const {
+    std::vector<BindableAction> res;
+    res.reserve(m_actionOrder.size());
+    for (auto handle : m_actionOrder) {
+        auto& action = m_actions.at(handle.getValue());
+        if (action.registered) {
+            res.push_back(action.definition);
+        }
+    }
+    return res;
+}
+
+std::vector<BindableAction> BindManager::getBindablesIn(Category const& category, bool sub) const {
+    std::vector<BindableAction> res;
+    for (auto handle : m_actionOrder) {
+        auto& action = m_actions.at(handle.getValue());
+        if (!action.registered) {
+            continue;
+        }
+        if (sub ?
+            action.definition.getCategory().hasParent(category) :
+            (action.definition.getCategory() == category)
+        ) {
+            res.push_back(action.definition);
+        }
+    }
+    return res;
+}
+
+std::vector<BindableAction> BindManager::getBindablesFor(Bind* bind) const {
+    return this->getBindablesFor(this->getKeyFor(bind));
+}
+
+std::vector<BindableAction> BindManager::getBindablesFor(BindKey key) const {
+    std::vector<BindableAction> res {};
+    const_cast<BindManager*>(this)->loadPendingFor(key);
+    if (key && m_binds.contains(key)) {
+        for (auto& handle : m_binds.at(key)) {
+            auto& action = m_actions.at(handle.getValue());
+            if (action.registered) {
+                res.push_back(action.definition);
+            }
+        }
+    }
+    return res;
+}
+
+std::vector<Category> BindManager::getAllCategories() const {
+    return m_categories;
+}
+
+void BindManager::addCategory(Category const& category) {
+    if (!ranges::contains(m_categories, category)) {
+        // Add parent categories first if they don't exist yet
+        if (auto parent = category.getParent()) {
+            this->addCategory(parent.value());
+        }
+        auto it = m_categories.begin();
+        bool foundParent = false;
+        for (auto& cat : m_categories) {
+            if (cat.hasParent(category)) {
+                foundParent = true;
+            }
+            else if (foundParent) {
+                break;
+            }
+            it++;
+        }
+        m_categories.insert(it, category);
+    }
+}
+
+void BindManager::removeCategory(Category const& category) {
+    BindBatch batch;
+    for (auto& bindable : this->getBindablesIn(category, true)) {
+        this->removeBindable(bindable.getID());
+    }
+    ranges::remove(m_categories, [&](auto const& cat) { return cat.hasParent(category); });
+}
+
+void BindManager::addBindTo(ActionID const& action, Bind* bind) {
+    this->loadPending(action);
+    if (m_devices.contains(bind->getDeviceID())) {
+        this->bind(this->getActionHandle(action), this->internBind(bind));
+    }
+    else {
+        m_devicelessBinds[bind->getDeviceID()][action].insert(this->saveBind(bind));
+        this->markDirty(this->getActionHandle(action));
+    }
+}
+
+void BindManager::removeBindFrom(ActionID const& action, Bind* bind) {
+    this->loadPending(action);
+    auto key = this->getKeyFor(bind);
+    auto found = m_actionHandles.find(action);
+    if (key && found != m_actionHandles.end()) {
+        this->unbind(found->second, key);
+    }
+}
+
+void BindManager::removeAllBindsFrom(ActionID const& action) {
+    auto found = m_actionHandles.find(action);
+    if (found == m_actionHandles.end()) {
+        return;
+    }
+    this->loadPending(found->second);
+    // unbind erases from the list being iterated
+    auto keys = m_actions.at(found->second.getValue()).binds;
+    for (auto& key : keys) {
+        this->unbind(found->second, key);
+    }
+}
+
+void BindManager::bind(ActionHandle action, BindKey key) {
+    auto& actions = m_binds[key];
+    if (ranges::contains(actions, action)) {
+        return;
+    }
+    actions.push_back(action);
+    this->setKeyBound(key, true);
+    this->markDirty(action);
+    m_actions.at(action.getValue()).binds.push_back(key);
+}
+
+void BindManager::bindOrDefer(ActionHandle action, BindKey key) {
+    // keyboard binds are bound without creating their Bind objects
+    if (this->isAttached(key)) {
+        this->bind(action, key);
+    }
+    // addBindTo keeps the binds of detached devices until they're attached
+    else if (auto bind = this->createBind(key)) {
+        this->addBindTo(m_actions.at(action.getValue()).id, bind);
+    }
+}
+
+bool BindManager::isAttached(BindKey key) const {
+    if (key.getDevice() == BindKey::KEYBOARD) {
+        return true;
+    }
+    auto bind = this->createBind(key);
+    return bind && m_devices.contains(bind->getDeviceID());
+}
+
+void BindManager::bindDefaults(ActionHandle action) {
+    auto& definition = m_actions.at(action.getValue()).definition;
+    for (auto key : definition.m_defaultKeys) {
+        this->bindOrDefer(action, key);
+    }
+    auto id = definition.getID();
+    for (auto& def : definition.m_defaults) {
+        this->addBindTo(id, def);
+    }
+}
+
+void BindManager::loadBinds(ActionHandle action) {
+    auto id = m_actions.at(action.getValue()).id;
+    if (this->loadActionBinds(id)) {
+        // loading goes through addBindTo, but what was loaded is already
+        // what is saved
+        m_actions.at(action.getValue()).dirty = false;
+        m_actions.at(action.getValue()).journalPending = false;
+    }
+    else {
+        this->bindDefaults(action);
+    }
+}
+
+bool BindManager::deferLoad(ActionHandle action) {
+    auto& data = m_actions.at(action.getValue());
+    std::vector<BindKey> keys;
+    if (auto found = m_store.find(data.id); found != m_store.end()) {
+        // binds from other devices are only saved as JSON
+        if (!found->second->custom.empty()) {
+            return false;
+        }
+        keys = found->second->keys;
+    }
+    // only saved as JSON, which would have to be parsed to find the keys
+    else if (Mod::get()->hasSavedValue(data.id)) {
+        return false;
+    }
+    else {
+        keys = data.definition.m_defaultKeys;
+        for (auto& def : data.definition.m_defaults) {
+            auto key = this->getKeyFor(def);
+            if (key.getDevice() != BindKey::KEYBOARD && key.getDevice() != BindKey::CONTROLLER) {
+                return false;
+            }
+            keys.push_back(key);
+        }
+    }
+    for (auto key : keys) {
+        m_pendingKeys[key].push_back(action);
+    }
+    data.loaded = false;
+    m_pendingActions += 1;
+    return true;
+}
+
+bool BindManager::takePending(ActionHandle action) {
+    auto& data = m_actions.at(action.getValue());
+    if (data.loaded) {
+        return false;
+    }
+    data.loaded = true;
+    m_pendingActions -= 1;
+    if (m_pendingActions == 0) {
+        m_pendingKeys.clear();
+    }
+    return true;
+}
+
+void BindManager::loadPending(ActionHandle action) {
+    if (this->takePending(action) && m_actions.at(action.getValue()).registered) {
+        this->loadBinds(action);
+    }
+}
+
+void BindManager::loadPending(ActionID const& action) {
+    if (m_pendingActions == 0) {
+        return;
+    }
+    if (auto found = m_actionHandles.find(action); found != m_actionHandles.end()) {
+        this->loadPending(found->second);
+    }
+}
+
+void BindManager::loadPendingFor(BindKey key) {
+    if (m_pendingActions == 0) {
+        return;
+    }
+    auto found = m_pendingKeys.find(key);
+    if (found == m_pendingKeys.end()) {
+        return;
+    }
+    auto actions = std::move(found->second);
+    m_pendingKeys.erase(found);
+    for (auto action : actions) {
+        this->loadPending(action);
+    }
+}
+
+void BindManager::unbind(ActionHandle action, BindKey key) {
+    if (auto found = m_binds.find(key); found != m_binds.end()) {
+        ranges::remove(found->second, action);
+        if (found->second.empty()) {
+            this->setKeyBound(key, false);
+            m_binds.erase(found);
+        }
+    }
+    ranges::remove(m_actions.at(action.getValue()).binds, key);
+    this->markDirty(action);
+    // the key's release would no longer reach this action
+    this->release(action);
+}
+
+void BindManager::release(ActionHandle action) {
+    if (m_batchDepth > 0) {
+        m_batchReleases.push_back(action);
+        return;
+    }
+    this->setActionHeld(action, false);
+    this->unrepeat(action);
+}
+
+void BindManager::setActionHeld(ActionHandle action, bool held) {
+    if (action.getValue() >= m_heldActions.size()) {
+        if (!held) {
+            return;
+        }
+        m_heldActions.resize(m_actions.size());
+    }
+    m_heldActions[action.getValue()] = held;
+}
+
+bool BindManager::isActionHeld(ActionHandle action) const {
+    return action.getValue() < m_heldActions.size() && m_heldActions[action.getValue()];
+}
+
+bool BindManager::isActionHeld(ActionID const& action) const {
+    if (auto handle = m_actionHandles.find(action); handle != m_actionHandles.end()) {
+        return this->isActionHeld(handle->second);
+    }
+    return false;
+}
+
+void BindManager::setKeyBound(BindKey key, bool bound) {
+    // keys with modifiers that don't fit in the bitset are only looked up
+    // in m_binds, so the bitset can't get out of sync with it
+    if (
+        key.getDevice() != BindKey::KEYBOARD ||
+        key.getCode() >= m_boundModifiers.size() ||
+        static_cast<unsigned>(key.getModifiers()) >= 16
+    ) {
+        return;
+    }
+    auto bit = static_cast<uint16_t>(1u << static_cast<unsigned>(key.getModifiers()));
+    if (bound) {
+        m_boundModifiers[key.getCode()] |= bit;
+    }
+    else {
+        m_boundModifiers[key.getCode()] &= ~bit;
+    }
+}
+
+bool BindManager::isKeyBound(enumKeyCodes key, Modifier modifiers) const {
+    if (m_pendingActions && m_pendingKeys.contains(BindKey::keyboard(key, modifiers))) {
+        return true;
+    }
+    if (
+        key < 0 || static_cast<size_t>(key) >= m_boundModifiers.size() ||
+        static_cast<unsigned>(modifiers) >= 16
+    ) {
+        return m_binds.contains(BindKey::keyboard(key, modifiers));
+    }
+    return m_boundModifiers[key] & (1u << static_cast<unsigned>(modifiers));
+}
+
+bool BindManager::isKeyHeld(enumKeyCodes key) const {
+    return key >= 0 && static_cast<size_t>(key) < KEY_CODE_COUNT && m_heldKeys.test(key);
+}
+
+void BindManager::setKeyHeld(enumKeyCodes key, bool held) {
+    if (key >= 0 && static_cast<size_t>(key) < KEY_CODE_COUNT) {
+        m_heldKeys.set(key, held);
+    }
+}
+
+std::vector<Ref<Bind>> BindManager::getBindsFor(ActionID const& action) const {
+    // loading doesn't change what the action's binds are seen to be
+    const_cast<BindManager*>(this)->loadPending(action);
+    std::vector<Ref<Bind>> binds;
+    if (auto data = this->findAction(action)) {
+        for (auto& key : data->binds) {
+            // keyboard and controller binds are created on demand
+            if (auto bind = this->createBind(key)) {
+                binds.push_back(bind);
+            }
+        }
+    }
+    return binds;
+}
+
+void BindManager::resetBindsToDefault(ActionID const& action) {
+    // the saved binds would be removed right away. Dropping them is a change
+    // even if the action ends up with no binds, so it has to be saved
+    if (auto found = m_actionHandles.find(action); found != m_actionHandles.end()) {
+        if (this->takePending(found->second)) {
+            this->markDirty(found->second);
+        }
+    }
+    this->removeAllBindsFrom(action);
+    if (this->getActionData(action)) {
+        if (auto repeat = this->getRepeatOptionsFor(action)) {
+            this->setRepeatOptionsFor(action, RepeatOptions());
+        }
+        this->bindDefaults(m_actionHandles.at(action));
+    }
+}
+
+void BindManager::resetAllBindsToDefault() {
+    BindBatch batch;
+    for (auto handle : m_actionOrder) {
+        this->resetBindsToDefault(m_actions.at(handle.getValue()).id);
+    }
+}
+
+void BindManager::beginBatch() {
+    m_batchDepth += 1;
+}
+
+void BindManager::endBatch() {
+    if (m_batchDepth == 0 || --m_batchDepth > 0) {
+        return;
+    }
+    // an action may have been released several times during the batch
+    auto releases = std::move(m_batchReleases);
+    m_batchReleases.clear();
+    std::sort(releases.begin(), releases.end(), [](auto a, auto b) {
+        return a.getValue() < b.getValue();
+    });
+    releases.erase(std::unique(releases.begin(), releases.end()), releases.end());
+    for (auto action : releases) {
+        this->release(action);
+    }
+    this->compactActionOrder();
+    if (!m_journalQueue.empty()) {
+        this->scheduleJournal();
+    }
+}
+
+bool BindManager::isBatching() const {
+    return m_batchDepth > 0;
+}
+
+BindBatch::BindBatch() {
+    BindManager::get()->beginBatch();
+}
+
+BindBatch::~BindBatch() {
+    BindManager::get()->endBatch();
+}
+
+bool BindManager::hasDefaultBinds(ActionID const& action) const {
+    const_cast<BindManager*>(this)->loadPending(action);
+    auto data = this->getActionData(action);
+    if (!data) {
+        return false;
+    }
+    // in the same order bindDefaults binds them
+    std::vector<BindKey> defaults;
+    for (auto key : data->definition.m_defaultKeys) {
+        if (this->isAttached(key)) {
+            defaults.push_back(key);
+        }
+    }
+    for (auto& def : data->definition.m_defaults) {
+        if (m_devices.contains(def->getDeviceID())) {
+            defaults.push_back(this->getKeyFor(def));
+        }
+    }
+    return data->binds == defaults;
+}
+
+std::optional<RepeatOptions> BindManager::getRepeatOptionsFor(ActionID const& action) {
+    this->loadPending(action);
+    if (auto data = this->getActionData(action)) {
+        if (data->definition.isRepeatable()) {
+            return data->repeat;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<RepeatOptions> BindManager::getRepeatOptionsFor(ActionHandle action) {
+    this->loadPending(action);
+    if (auto data = this->getActionData(action)) {
+        if (data->definition.isRepeatable()) {
+            return data->repeat;
+        }
+    }
+    return std::nullopt;
+}
+
+void BindManager::setRepeatOptionsFor(ActionID const& action, RepeatOptions const& options) {
+    this->loadPending(action);
+    if (auto data = this->getActionData(action)) {
+        data->repeat = options;
+        this->markDirty(m_actionHandles.at(action));
+    }
+}
+
+void BindManager::markDirty(ActionHandle action) {
+    auto& data = m_actions.at(action.getValue());
+    if (!data.dirty) {
+        data.dirty = true;
+        m_dirtyActions.push_back(action);
+    }
+    this->queueJournal(action);
+}
+
+ListenerResult BindManager::onDispatch(PressBindEvent* event) {
+    // only inputs that were timestamped by the input hook are profiled
+    auto timestamp = m_profiling ? event->getTimestamp() : std::nullopt;
+    Timestamp mark;
+    if (timestamp) {
+        mark = std::chrono::steady_clock::now();
+        this->recordLatency(LatencyStage::Input, *timestamp, mark);
+    }
+
+    // presses from built-in devices carry their key, so they never have to
+    // create the bind to be looked up
+    this->loadPendingFor(event->getKey());
+    auto found = m_binds.find(event->getKey());
+    if (timestamp) {
+        auto now = std::chrono::steady_clock::now();
+        this->recordLatency(LatencyStage::Lookup, mark, now);
+        mark = now;
+    }
+    if (found != m_binds.end()) {
+        // listeners are called synchronously and may change the binds, which
+        // would leave a reference into m_binds dangling
+        auto actions = found->second;
+        for (auto action : actions) {
+            bool inserted = false;
+            if (event->isDown()) {
+                if (!this->isActionHeld(action)) {
+                    this->setActionHeld(action, true);
+                    inserted = true;
+                }
+                if (this->isRepeating(action)) {
+                    return ListenerResult::Stop;
+                }
+                this->repeat(action);
+            }
+            else {
+                this->setActionHeld(action, false);
+                this->unrepeat(action);
+            }
+            auto options = this->getRepeatOptionsFor(action);
+            if ((!options.has_value() || !options.value().enabled) && !inserted && this->isActionHeld(action)) {
+                return ListenerResult::Stop;
+            }
+            if (timestamp) {
+                auto now = std::chrono::steady_clock::now();
+                this->recordLatency(LatencyStage::Repeat, mark, now);
+                mark = now;
+            }
+            auto result = this->invoke(action, event->isDown(), timestamp);
+            if (timestamp) {
+                auto now = std::chrono::steady_clock::now();
+                this->recordLatency(LatencyStage::Listeners, mark, now);
+                mark = now;
+                auto& data = m_actions.at(action.getValue());
+                if (!data.latency) {
+                    data.latency = std::make_unique<LatencyHistogram>();
+                }
+                data.latency->record(now - *timestamp);
+            }
+            if (result == ListenerResult::Stop) {
+                return ListenerResult::Stop;
+            }
+        }
+    }
+    return ListenerResult::Propagate;
+}
+
+ListenerResult BindManager::invoke(ActionHandle action, bool down, std::optional<Timestamp> timestamp) {
+    if (action.getValue() >= m_actions.size()) {
+        return ListenerResult::Propagate;
+    }
+    auto event = InvokeBindEvent(action, down);
+    event.m_direct = true;
+    event.m_timestamp = timestamp;
+    // the event goes to Geode's listeners first, so mods can still stop the
+    // built-in actions like they could when those used InvokeBindFilter
+    if (m_postingAllInvokes || m_actions.at(action.getValue()).legacyFilters > 0) {
+        if (event.post() == ListenerResult::Stop) {
+            return ListenerResult::Stop;
+        }
+    }
+    return this->invokeListeners(&event);
+}
+
+ListenerResult BindManager::onInvoke(InvokeBindEvent* event) {
+    // events we posted ourselves have already been given to the listeners
+    if (event->m_direct) {
+        return ListenerResult::Propagate;
+    }
+    return this->invokeListeners(event);
+}
+
+ListenerResult BindManager::invokeListeners(InvokeBindEvent* event) {
+    auto index = event->getHandle().getValue();
+    if (index >= m_actions.size()) {
+        return ListenerResult::Propagate;
+    }
+    auto result = ListenerResult::Propagate;
+    m_dispatchDepth += 1;
+    // listeners added by a callback only get the next event
+    auto count = m_actions.at(index).listeners.size();
+    for (size_t i = 0; i < count; i++) {
+        // callbacks may intern new actions and reallocate m_actions, and may
+        // also release the listener that is being called
+        Ref<ActionListener> listener = m_actions.at(index).listeners.at(i);
+        if (listener && listener->m_callback(event) == ListenerResult::Stop) {
+            result = ListenerResult::Stop;
+            break;
+        }
+    }
+    m_dispatchDepth -= 1;
+    if (m_dispatchDepth == 0) {
+        for (auto& stale : m_staleListeners) {
+            ranges::remove(m_actions.at(stale.getValue()).listeners, nullptr);
+        }
+        m_staleListeners.clear();
+    }
+    return result;
+}
+
+void BindManager::addListener(ActionListener* listener) {
+    m_actions.at(listener->m_action.getValue()).listeners.push_back(listener);
+}
+
+void BindManager::removeListener(ActionListener* listener) {
+    auto& listeners = m_actions.at(listener->m_action.getValue()).listeners;
+    // erasing would shift the listeners of an action that is being invoked
+    if (m_dispatchDepth > 0) {
+        for (auto& l : listeners) {
+            if (l == listener) {
+                l = nullptr;
+            }
+        }
+        m_staleListeners.push_back(listener->m_action);
+    }
+    else {
+        ranges::remove(listeners, listener);
+    }
+}
+
+void BindManager::recordLatency(LatencyStage stage, Timestamp from, Timestamp to) {
+    m_stageLatencies.at(static_cast<size_t>(stage)).record(to - from);
+}
+
+void BindManager::setProfiling(bool enabled) {
+    m_profiling = enabled;
+}
+
+bool BindManager::isProfiling() const {
+    return m_profiling;
+}
+
+void BindManager::setPostingAllInvokes(bool enabled) {
+    m_postingAllInvokes = enabled;
+}
+
+bool BindManager::isPostingAllInvokes() const {
+    return m_postingAllInvokes;
+}
+
+LatencyHistogram const* BindManager::getLatencyFor(ActionID const& action) const {
+    if (auto data = this->findAction(action)) {
+        return data->latency.get();
+    }
+    return nullptr;
+}
+
+LatencyHistogram const& BindManager::getLatencyFor(LatencyStage stage) const {
+    return m_stageLatencies.at(static_cast<size_t>(stage));
+}
+
+void BindManager::resetLatencies() {
+    for (auto& histogram : m_stageLatencies) {
+        histogram.reset();
+    }
+    for (auto& data : m_actions) {
+        data.latency = nullptr;
+    }
+}
+
+static std::string formatLatency(std::string const& name, LatencyHistogram const& histogram) {
+    auto us = [](std::chrono::nanoseconds ns) {
+        return ns.count() / 1000.0;
+    };
+    return fmt::format(
+        "{}: {} samples, min {:.2f}us, mean {:.2f}us, p50 {:.2f}us, "
+        "p90 {:.2f}us, p99 {:.2f}us, p99.9 {:.2f}us, max {:.2f}us\n",
+        name, histogram.getCount(),
+        us(histogram.getMin()), us(histogram.getMean()),
+        us(histogram.getPercentile(50)), us(histogram.getPercentile(90)),
+        us(histogram.getPercentile(99)), us(histogram.getPercentile(99.9)),
+        us(histogram.getMax())
+    );
+}
+
+bool BindManager::dumpLatencies(std::filesystem::path const& path) const {
+    std::string out = "Stages\n";
+    constexpr std::array<const char*, LATENCY_STAGE_COUNT> STAGE_NAMES {
+        "input", "lookup", "repeat", "listeners"
+    };
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        out += formatLatency(STAGE_NAMES[i], m_stageLatencies[i]);
+    }
+    out += "\nActions (input to listeners done)\n";
+    for (auto& data : m_actions) {
+        if (data.latency) {
+            out += formatLatency(data.id, *data.latency);
+        }
+    }
+    return file::writeString(path, out).isOk();
+}
+
+bool BindManager::RepeatTimer::operator>(RepeatTimer const& other) const {
+    return deadline > other.deadline;
+}
+
+void BindManager::stopAllRepeats() {
+    if (m_activeRepeats > 0) {
+        for (auto& data : m_actions) {
+            if (data.repeating) {
+                data.repeating = false;
+                data.repeatGeneration += 1;
+            }
+        }
+        m_activeRepeats = 0;
+    }
+    // onRepeat unschedules itself on its next tick
+    m_repeatQueue.clear();
+}
+
+void BindManager::unrepeat(ActionHandle action) {
+    if (action.getValue() >= m_actions.size()) {
+        return;
+    }
+    auto& data = m_actions.at(action.getValue());
+    if (data.repeating) {
+        data.repeating = false;
+        data.repeatGeneration += 1;
+        m_activeRepeats -= 1;
+        // nothing left to fire, so drop the stale timers. onRepeat
+        // unschedules itself on its next tick, which keeps releasing and
+        // pressing again in the same frame from touching the scheduler
+        if (m_activeRepeats == 0) {
+            m_repeatQueue.clear();
+        }
+    }
+}
+
+bool BindManager::isRepeating(ActionHandle action) const {
+    return action.getValue() < m_actions.size() && m_actions.at(action.getValue()).repeating;
+}
+
+void BindManager::pushRepeatTimer(RepeatTimer timer) {
+    m_repeatQueue.push_back(timer);
+    std::push_heap(m_repeatQueue.begin(), m_repeatQueue.end(), std::greater<>());
+}
+
+void BindManager::repeat(ActionHandle action) {
+    // this is why you are supposed to pimpl stuff now i cant change the return type
+    if (auto options = this->getRepeatOptionsFor(action)) {
+        if (options.value().enabled) {
+            auto& data = m_actions.at(action.getValue());
+            if (!data.repeating) {
+                data.repeating = true;
+                m_activeRepeats += 1;
+            }
+            data.repeatGeneration += 1;
+            this->pushRepeatTimer({
+                m_repeatClock + options.value().delay / 1000.0,
+                action, data.repeatGeneration
+            });
+            if (!m_repeatScheduled) {
+                m_repeatScheduled = true;
+                CCScheduler::get()->scheduleSelector(
+                    schedule_selector(BindManager::onRepeat), this,
+                    0.f, false
+                );
+            }
+        }
+    }
+}
+
+void BindManager::onRepeat(float dt) {
+    if (m_activeRepeats == 0) {
+        m_repeatScheduled = false;
+        CCScheduler::get()->unscheduleSelector(
+            schedule_selector(BindManager::onRepeat), this
+        );
+        return;
+    }
+    m_repeatClock += dt;
+    // actions fire at most once per frame, so timers that are still due
+    // after firing are only requeued once the frame's timers are done
+    std::vector<RepeatTimer> fired;
+    while (!m_repeatQueue.empty() && m_repeatQueue.front().deadline <= m_repeatClock) {
+        std::pop_heap(m_repeatQueue.begin(), m_repeatQueue.end(), std::greater<>());
+        auto timer = m_repeatQueue.back();
+        m_repeatQueue.pop_back();
+
+        auto& data = m_actions.at(timer.action.getValue());
+        if (!data.repeating || data.repeatGeneration != timer.generation) {
+            continue;
+        }
+        auto options = this->getRepeatOptionsFor(timer.action);
+        if (!options || !options.value().enabled) {
+            this->unrepeat(timer.action);
+            continue;
+        }
+        timer.deadline += options.value().rate / 1000.0;
+        fired.push_back(timer);
+        this->invoke(timer.action, true);
+    }
+    for (auto& timer : fired) {
+        // the listeners may have released the key or stopped all repeats
+        auto& data = m_actions.at(timer.action.getValue());
+        if (data.repeating && data.repeatGeneration == timer.generation) {
+            this->pushRepeatTimer(timer);
+        }
+    }
+}
+
+void BindManager::save() {
+    if (m_dirtyActions.empty()) {
+        return;
+    }
+    // only actions whose binds have changed need to be written again.
+    // Actions that have been removed keep what was saved for them
+    for (auto handle : m_dirtyActions) {
+        auto& data = m_actions.at(handle.getValue());
+        if (data.dirty && data.registered) {
+            this->saveActionBinds(data.id);
+        }
+        data.dirty = false;
+        // the store written below has these changes
+        data.journalPending = false;
+    }
+    m_dirtyActions.clear();
+
+    // the JSON save data stays complete, so it can be used if the store is
+    // turned off or can't be read. The generation and sequence number tie
+    // the two together
+    if (m_useStore) {
+        m_storeGeneration += 1;
+        Mod::get()->setSavedValue<int>("binary-store-generation", static_cast<int>(m_storeGeneration));
+        Mod::get()->setSavedValue<int>("journal-seq", static_cast<int>(m_journalSeq));
+        this->writeStore();
+    }
+}
+
+$on_mod(DataSaved) {
+    BindManager::get()->save();
+}
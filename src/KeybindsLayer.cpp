@@ -6,6 +6,11 @@
 #include <Geode/binding/CCMenuItemToggler.hpp>
 #include <Geode/ui/General.hpp>
 #include <Geode/ui/Scrollbar.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <queue>
+#include <variant>
 
 static ButtonSprite* createBindBtn(CCSprite* top) {
     auto spr = ButtonSprite::create(top, 18, true, 0, "square.png"_spr, 2.f);
@@ -26,18 +31,28 @@ static ButtonSprite* createBindBtn(const char* text) {
 }
 
 class FoldableLayer : public CCNode {
+public:
+    static constexpr float HEIGHT = 25.f;
+
 protected:
     KeybindsLayer* m_layer;
     bool m_folded = false;
     CCSprite* m_foldSpr;
+    CCSprite* m_arrow;
+    CCLabelBMFont* m_titleLabel;
+    float m_width;
+    // the row this header is showing in the virtualized list. Its children
+    // are rows of their own there, so folding is left to the layer
+    std::optional<size_t> m_row;
 
     bool init(KeybindsLayer* layer, std::string const& title, float width, size_t offset) {
         if (!CCNode::init())
             return false;
 
         m_layer = layer;
+        m_width = width;
 
-        constexpr float height = 25.f;
+        constexpr float height = HEIGHT;
 
         auto bg = CCLayerColor::create({ 0, 0, 0, 85 });
         bg->ignoreAnchorPointForPosition(false);
@@ -59,20 +74,19 @@ protected:
         menu->addChild(foldBtn);
         bg->addChild(menu);
 
-        if (offset > 0) {
-            auto arrow = CCSprite::create("turn-arrow.png"_spr);
-            arrow->setPosition({ height / 2 + 10.f, height / 2 });
-            arrow->setOpacity(85);
-            bg->addChild(arrow);
-            limitNodeSize(arrow, { height - 10.f, height - 10.f }, 1.f, .1f);
-        }
-        auto titleLabel = CCLabelBMFont::create(title.c_str(), "bigFont.fnt");
-        titleLabel->setOpacity(180);
-        titleLabel->setColor({ 180, 180, 180 });
-        titleLabel->setPosition(height / 2 + (offset ? 20.f : 0.f), height / 2);
-        titleLabel->setAnchorPoint({ .0f, .5f });
-        bg->addChild(titleLabel);
-        limitNodeSize(titleLabel, { width - height * 2, height - 10.f }, 1.f, .1f);
+        m_arrow = CCSprite::create("turn-arrow.png"_spr);
+        m_arrow->setPosition({ height / 2 + 10.f, height / 2 });
+        m_arrow->setOpacity(85);
+        bg->addChild(m_arrow);
+        limitNodeSize(m_arrow, { height - 10.f, height - 10.f }, 1.f, .1f);
+
+        m_titleLabel = CCLabelBMFont::create("", "bigFont.fnt");
+        m_titleLabel->setOpacity(180);
+        m_titleLabel->setColor({ 180, 180, 180 });
+        m_titleLabel->setAnchorPoint({ .0f, .5f });
+        bg->addChild(m_titleLabel);
+
+        this->setTitle(title, offset);
 
         this->addChild(bg);
 
@@ -81,14 +95,25 @@ protected:
         return true;
     }
 
+    void setTitle(std::string const& title, size_t offset) {
+        m_arrow->setVisible(offset > 0);
+        m_titleLabel->setString(title.c_str());
+        m_titleLabel->setPosition(HEIGHT / 2 + (offset ? 20.f : 0.f), HEIGHT / 2);
+        limitNodeSize(m_titleLabel, { m_width - HEIGHT * 2, HEIGHT - 10.f }, 1.f, .1f);
+    }
+
     void onFold(CCObject*) {
         m_folded ^= 1;
+        m_foldSpr->setFlipY(m_folded);
+        if (m_row) {
+            m_layer->setRowFolded(*m_row, m_folded);
+            return;
+        }
         for (auto child : CCArrayExt<CCNode*>(m_pChildren)) {
             if (child->getID() != "fold-layer") {
                 child->setVisible(!m_folded);
             }
         }
-        m_foldSpr->setFlipY(m_folded);
         m_layer->updateVisibility();
     }
 
@@ -106,6 +131,16 @@ public:
     bool isFolded() const {
         return m_folded;
     }
+
+    /**
+     * Show a different row of the virtualized list in this header
+     */
+    void setRow(size_t row, std::string const& title, size_t offset, bool folded) {
+        m_row = row;
+        m_folded = folded;
+        m_foldSpr->setFlipY(folded);
+        this->setTitle(title, offset);
+    }
 };
 
 bool EnterBindLayer::setup(BindableNode* node, Bind* original) {
@@ -347,10 +382,9 @@ bool BindableNode::init(
     constexpr float height = 30.f;
 
     m_layer = layer;
-    m_action = action;
     this->setContentSize({ width, height });
 
-    m_bg = CCLayerColor::create({ 0, 0, 0, GLubyte(bgColor ? 120 : 70) });
+    m_bg = CCLayerColor::create({ 0, 0, 0, 70 });
     m_bg->ignoreAnchorPointForPosition(false);
     m_bg->setAnchorPoint({ 0.f, 0.f });
     m_bg->setContentSize({ width, height });
@@ -361,6 +395,34 @@ bool BindableNode::init(
     m_nameMenu->setAnchorPoint({ .0f, .5f });
     m_nameMenu->setPosition(height / 2, height / 2);
     m_nameMenu->ignoreAnchorPointForPosition(false);
+    this->addChild(m_nameMenu);
+
+    m_bindMenu = CCMenu::create();
+    m_bindMenu->setContentSize({ width / 2 - height, height });
+    m_bindMenu->ignoreAnchorPointForPosition(false);
+    m_bindMenu->setPosition(width - height / 2, height / 2);
+    m_bindMenu->setAnchorPoint({ 1.f, .5f });
+    m_bindMenu->setLayout(
+        RowLayout::create()
+            ->setAxisReverse(true)
+            ->setAxisAlignment(AxisAlignment::End)
+    );
+    this->addChild(m_bindMenu);
+
+    this->setAction(action, bgColor);
+
+    return true;
+}
+
+void BindableNode::setAction(BindableAction const& action, bool bgColor, bool expand) {
+    constexpr float height = 30.f;
+    auto width = m_obContentSize.width;
+
+    m_action = action;
+    m_expand = expand;
+    m_bg->setOpacity(bgColor ? 120 : 70);
+
+    m_nameMenu->removeAllChildren();
 
     auto nameLabel = CCLabelBMFont::create(action.getName().c_str(), "bigFont.fnt");
     nameLabel->setPosition(0.f, height / 2);
@@ -387,23 +449,7 @@ bool BindableNode::init(
     infoBtn->setPosition(nameLabel->boundingBox().getMaxX() + 15.f, height / 2);
     m_nameMenu->addChild(infoBtn);
 
-    this->addChild(m_nameMenu);
-
-    m_bindMenu = CCMenu::create();
-    m_bindMenu->setContentSize({ width / 2 - height, height });
-    m_bindMenu->ignoreAnchorPointForPosition(false);
-    m_bindMenu->setPosition(width - height / 2, height / 2);
-    m_bindMenu->setAnchorPoint({ 1.f, .5f });
-    m_bindMenu->setLayout(
-        RowLayout::create()
-            ->setAxisReverse(true)
-            ->setAxisAlignment(AxisAlignment::End)
-    );
-    this->addChild(m_bindMenu);
-
     this->updateMenu(false);
-
-    return true;
 }
 
 void BindableNode::updateMenu(bool updateLayer) {
@@ -535,14 +581,8 @@ BindableAction const& BindableNode::getAction() const {
     return m_action;
 }
 
-std::string BindableNode::getMatchString() const {
-    auto res = m_action.getMod()->getName() + " " +
-        m_action.getCategory().toString() + " " +
-        m_action.getName() + " ";
-    for (auto& bind : BindManager::get()->getBindsFor(m_action.getID())) {
-        res += bind->toString() + ", ";
-    }
-    return res;
+bool BindableNode::isExpanded() const {
+    return m_expand;
 }
 
 BindableNode* BindableNode::create(
@@ -559,6 +599,23 @@ BindableNode* BindableNode::create(
     return nullptr;
 }
 
+// the most results a ranked search shows
+static constexpr size_t MAX_RANKED_RESULTS = 50;
+
+// A query is a bind if it's "bind:" followed by one, or if it's a bind with
+// modifiers like "Ctrl+Z". Plain key names are searched as text
+static BindKey parseBindQuery(std::string const& query) {
+    if (query.starts_with("bind:")) {
+        return parseBindKey(std::string_view(query).substr(5)).value_or(BindKey());
+    }
+    if (query.find('+') != std::string::npos) {
+        if (auto key = parseBindKey(query); key && key->getModifiers() != Modifier::None) {
+            return *key;
+        }
+    }
+    return BindKey();
+}
+
 bool KeybindsLayer::setup() {
     m_noElasticity = true;
     this->setTitle("Customize Keybinds");
@@ -591,37 +648,14 @@ bool KeybindsLayer::setup() {
 
     m_scroll = ScrollLayer::create(scrollSize);
 
-    m_containers = { m_scroll->m_contentLayer };
-    for (auto& category : BindManager::get()->getAllCategories()) {
-        bool bgColor = false;
-        CCNode* target = m_scroll->m_contentLayer;
-        size_t offset = 0;
-        for (auto& path : category.getPath()) {
-            auto old = target;
-            target = target->getChildByID(path);
-            if (!target) {
-                target = FoldableLayer::create(this, path, scrollSize.width, offset);
-                target->setID(path);
-                old->addChild(target);
-                m_containers.insert(m_containers.begin(), target);
-            }
-            offset += 1;
-        }
-        for (auto& action : BindManager::get()->getBindablesIn(category)) {
-            auto node = BindableNode::create(this, action, scrollSize.width, bgColor ^= 1);
-            target->addChild(node);
-            m_nodes.push_back(node);
-        }
+    m_virtualized = Mod::get()->template getSettingValue<bool>("virtualize-keybinds-list");
+    m_rankedSearch = Mod::get()->template getSettingValue<bool>("ranked-keybinds-search");
+    if (m_virtualized) {
+        this->buildRows();
+        this->scheduleUpdate();
     }
-
-    for (auto& target : m_containers) {
-        auto layout = ColumnLayout::create()
-            ->setAxisReverse(true)
-            ->setCrossAxisLineAlignment(AxisAlignment::End)
-            ->setAxisAlignment(AxisAlignment::End)
-            ->setGap(0.f);
-        layout->ignoreInvisibleChildren(true);
-        target->setLayout(layout, false);
+    else {
+        this->buildContainers();
     }
 
     m_scroll->setPosition(winSize / 2 - scrollSize / 2 - ccp(0.f, 30.f));
@@ -644,14 +678,385 @@ bool KeybindsLayer::setup() {
     resetAllBtn->setPosition(m_size.width / 2 - 50.f, m_size.height / 2 - 20.f);
     m_buttonMenu->addChild(resetAllBtn);
 
+    auto captureSpr = ButtonSprite::create(
+        "Find Bind", "bigFont.fnt", "GJ_button_05.png", .75f
+    );
+    captureSpr->setScale(.5f);
+    auto captureBtn = CCMenuItemSpriteExtra::create(
+        captureSpr, this, menu_selector(KeybindsLayer::onCapture)
+    );
+    captureBtn->setPosition(-m_size.width / 2 + 65.f, m_size.height / 2 - 20.f);
+    m_buttonMenu->addChild(captureBtn);
+
     this->updateVisibility();
 
     return true;
 }
 
-void KeybindsLayer::updateVisibility() {
+static void setContainerLayout(CCNode* target) {
+    auto layout = ColumnLayout::create()
+        ->setAxisReverse(true)
+        ->setCrossAxisLineAlignment(AxisAlignment::End)
+        ->setAxisAlignment(AxisAlignment::End)
+        ->setGap(0.f);
+    layout->ignoreInvisibleChildren(true);
+    target->setLayout(layout, false);
+}
+
+void KeybindsLayer::buildContainers() {
+    m_containers = { m_scroll->m_contentLayer };
+    setContainerLayout(m_scroll->m_contentLayer);
+
+    // laid out by layoutResults, since it doesn't have a header
+    m_resultsContainer = CCNode::create();
+    m_resultsContainer->setID("ranked-results");
+    m_resultsContainer->setVisible(false);
+    setContainerLayout(m_resultsContainer);
+    m_scroll->m_contentLayer->addChild(m_resultsContainer);
+    for (auto& category : BindManager::get()->getAllCategories()) {
+        m_pendingNodes.push_back({ category });
+        bool bgColor = false;
+        for (auto& action : BindManager::get()->getBindablesIn(category)) {
+            m_pendingNodes.push_back({ category, action, bgColor ^= 1 });
+            m_searchIndex.add(action);
+        }
+    }
+
+    // the first screenful is built right away and the rest is streamed in
+    float height = 0.f;
+    while (
+        m_builtNodes < m_pendingNodes.size() &&
+        height < m_scroll->getContentSize().height
+    ) {
+        height += this->buildNode(m_pendingNodes.at(m_builtNodes++), true);
+    }
+    if (m_builtNodes < m_pendingNodes.size()) {
+        this->schedule(schedule_selector(KeybindsLayer::buildPending));
+    }
+}
+
+float KeybindsLayer::buildNode(PendingKeybindsNode const& pending, bool visible) {
+    auto width = m_scroll->getContentSize().width;
+    float height = 0.f;
+    CCNode* target = m_scroll->m_contentLayer;
+    size_t offset = 0;
+    for (auto& path : pending.category.getPath()) {
+        auto old = target;
+        target = target->getChildByID(path);
+        if (!target) {
+            target = FoldableLayer::create(this, path, width, offset);
+            target->setID(path);
+            // streamed nodes are shown once they've all been built, so the
+            // list doesn't have to be laid out for every frame
+            target->setVisible(visible);
+            setContainerLayout(target);
+            old->addChild(target);
+            m_containers.insert(m_containers.begin(), target);
+            height += FoldableLayer::HEIGHT;
+        }
+        offset += 1;
+    }
+    if (pending.action) {
+        auto node = BindableNode::create(this, *pending.action, width, pending.bgColor);
+        node->setVisible(visible);
+        target->addChild(node);
+        m_nodes.push_back(node);
+        height += node->getContentSize().height;
+    }
+    return height;
+}
+
+void KeybindsLayer::buildPending(float) {
+    // about a quarter of a frame at 60 fps
+    static constexpr auto BUDGET = std::chrono::milliseconds(4);
+
+    auto start = std::chrono::steady_clock::now();
+    while (m_builtNodes < m_pendingNodes.size()) {
+        this->buildNode(m_pendingNodes.at(m_builtNodes++), false);
+        if (std::chrono::steady_clock::now() - start >= BUDGET) {
+            break;
+        }
+    }
+    if (m_builtNodes < m_pendingNodes.size()) {
+        this->updateResultsLabel();
+        return;
+    }
+    this->unschedule(schedule_selector(KeybindsLayer::buildPending));
+    m_pendingNodes.clear();
+    m_builtNodes = 0;
+
+    // shows the streamed nodes that match the query and lays out the list
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+        auto node = m_nodes.at(i);
+        if (
+            node->getParent() == m_scroll->m_contentLayer ||
+            !static_cast<FoldableLayer*>(node->getParent())->isFolded()
+        ) {
+            node->setVisible(m_searchIndex.matches(i));
+        }
+    }
+    this->updateVisibility();
+}
+
+void KeybindsLayer::update(float) {
+    // the scroll layer doesn't say when it's scrolled
+    if (m_virtualized && m_scroll->m_contentLayer->getPositionY() != m_scrollY) {
+        if (this->updateRowNodes()) {
+            this->layoutRows();
+        }
+    }
+}
+
+void KeybindsLayer::buildRows() {
+    // the rows are the headers and actions of the category tree in
+    // depth-first order, the same order the regular list's nested
+    // containers show them in
+    struct Group {
+        std::string title;
+        size_t depth;
+        // subgroups by index and actions, in the order they were added
+        std::vector<std::variant<size_t, BindableAction>> items;
+    };
+    std::vector<Group> groups { Group { "", 0, {} } };
+    std::unordered_map<std::string, size_t> groupsByPath;
+    for (auto& category : BindManager::get()->getAllCategories()) {
+        size_t group = 0;
+        size_t depth = 0;
+        std::string path;
+        for (auto& part : category.getPath()) {
+            path += part + "/";
+            auto found = groupsByPath.find(path);
+            if (found == groupsByPath.end()) {
+                groups.at(group).items.push_back(groups.size());
+                found = groupsByPath.insert({ path, groups.size() }).first;
+                groups.push_back(Group { part, depth, {} });
+            }
+            group = found->second;
+            depth += 1;
+        }
+        for (auto& action : BindManager::get()->getBindablesIn(category)) {
+            groups.at(group).items.push_back(action);
+        }
+    }
+
+    m_rows.clear();
+    auto addGroup = [&](auto& self, size_t group, size_t parent) -> void {
+        bool bgColor = false;
+        for (auto& item : groups.at(group).items) {
+            KeybindsRow row;
+            row.parent = parent;
+            if (auto sub = std::get_if<size_t>(&item)) {
+                row.title = groups.at(*sub).title;
+                row.depth = groups.at(*sub).depth;
+                row.height = FoldableLayer::HEIGHT;
+                m_rows.push_back(std::move(row));
+                self(self, *sub, m_rows.size() - 1);
+            }
+            else {
+                row.action = std::get<BindableAction>(item);
+                row.depth = groups.at(group).depth + 1;
+                row.height = 30.f;
+                row.bgColor = bgColor ^= 1;
+                m_indexedRows.push_back(m_rows.size());
+                m_searchIndex.add(*row.action);
+                m_rows.push_back(std::move(row));
+            }
+        }
+    };
+    addGroup(addGroup, 0, KeybindsRow::NO_PARENT);
+}
+
+void KeybindsLayer::layoutRows() {
+    bool ranking = this->isRanking();
+    // headers are hidden during a search if nothing under them matches
+    if (m_query.size() && !ranking) {
+        for (auto& row : m_rows) {
+            row.hasMatch = false;
+        }
+        for (auto& row : m_rows) {
+            if (!row.action || !row.matches) {
+                continue;
+            }
+            auto parent = row.parent;
+            while (parent != KeybindsRow::NO_PARENT && !m_rows.at(parent).hasMatch) {
+                m_rows.at(parent).hasMatch = true;
+                parent = m_rows.at(parent).parent;
+            }
+        }
+    }
+
+    auto content = m_scroll->m_contentLayer;
+    size_t visible = 0;
+    // rows coming into view get measured, which can move the rows after
+    // them, so this is repeated until their heights settle
+    do {
+        auto oldHeight = content->getContentSize().height;
+        if (ranking) {
+            for (auto index : m_shownRows) {
+                m_rows.at(index).shown = false;
+            }
+        }
+        m_shownRows.clear();
+        m_rowOffsets.clear();
+        visible = 0;
+        float offset = 0.f;
+        // the results are shown without headers, best first
+        for (auto result : ranking ? m_results : std::vector<size_t>()) {
+            auto index = m_indexedRows.at(result);
+            auto& row = m_rows.at(index);
+            row.shown = true;
+            row.position = m_shownRows.size();
+            m_shownRows.push_back(index);
+            m_rowOffsets.push_back(offset);
+            offset += row.height;
+            visible += 1;
+        }
+        for (size_t i = 0; i < m_rows.size() && !ranking; i++) {
+            auto& row = m_rows.at(i);
+            row.shown = row.parent == KeybindsRow::NO_PARENT || (
+                m_rows.at(row.parent).shown && !m_rows.at(row.parent).folded
+            );
+            if (row.shown && m_query.size()) {
+                row.shown = row.action ? row.matches : row.hasMatch;
+            }
+            if (!row.shown) {
+                continue;
+            }
+            row.position = m_shownRows.size();
+            m_shownRows.push_back(i);
+            m_rowOffsets.push_back(offset);
+            offset += row.height;
+            if (row.action) {
+                visible += 1;
+            }
+        }
+        auto height = std::max(offset, m_scroll->getContentSize().height);
+        content->setContentSize({ m_scroll->getContentSize().width, height });
+        m_scroll->scrollLayer(oldHeight - height);
+    } while (this->updateRowNodes());
+
+    if (ranking) {
+        this->updateResultsLabel();
+        return;
+    }
+    m_resultsLabel->setString(fmt::format("Showing {} bindings", visible).c_str());
+}
+
+bool KeybindsLayer::updateRowNodes() {
+    auto content = m_scroll->m_contentLayer;
+    auto width = content->getContentSize().width;
+    auto height = content->getContentSize().height;
+    auto viewHeight = m_scroll->getContentSize().height;
+    m_scrollY = content->getPositionY();
+
+    // the part of the list in view, as distances from its top
+    auto viewTop = height + m_scrollY - viewHeight;
+    auto viewBottom = viewTop + viewHeight;
+    size_t first = std::upper_bound(m_rowOffsets.begin(), m_rowOffsets.end(), viewTop) - m_rowOffsets.begin();
+    if (first > 0) {
+        first -= 1;
+    }
+    size_t last = std::lower_bound(m_rowOffsets.begin(), m_rowOffsets.end(), viewBottom) - m_rowOffsets.begin();
+
+    std::vector<size_t> outOfView;
+    for (auto& [index, node] : m_rowNodes) {
+        auto& row = m_rows.at(index);
+        if (!row.shown || row.position < first || row.position >= last) {
+            outOfView.push_back(index);
+        }
+    }
+    for (auto index : outOfView) {
+        this->releaseRowNode(index);
+    }
+
+    bool changed = false;
+    for (auto position = first; position < last; position++) {
+        auto index = m_shownRows.at(position);
+        auto& row = m_rows.at(index);
+        CCNode* node;
+        if (auto found = m_rowNodes.find(index); found != m_rowNodes.end()) {
+            node = found->second;
+        }
+        else if (row.action) {
+            // the results alternate colors by their place in the ranking
+            bool bgColor = this->isRanking() ? position % 2 == 0 : row.bgColor;
+            BindableNode* bindable;
+            if (m_freeNodes.size()) {
+                bindable = m_freeNodes.back();
+                m_freeNodes.pop_back();
+                bindable->setAction(*row.action, bgColor, row.expanded);
+            }
+            else {
+                bindable = BindableNode::create(this, *row.action, width, bgColor);
+                if (row.expanded) {
+                    bindable->setAction(*row.action, bgColor, true);
+                }
+                content->addChild(bindable);
+            }
+            node = bindable;
+        }
+        else {
+            FoldableLayer* header;
+            if (m_freeHeaders.size()) {
+                header = m_freeHeaders.back();
+                m_freeHeaders.pop_back();
+            }
+            else {
+                header = FoldableLayer::create(this, row.title, width, row.depth);
+                content->addChild(header);
+            }
+            header->setRow(index, row.title, row.depth, row.folded);
+            node = header;
+        }
+        node->setVisible(true);
+        m_rowNodes[index] = node;
+        if (node->getContentSize().height != row.height) {
+            row.height = node->getContentSize().height;
+            changed = true;
+        }
+        node->setPosition(0.f, height - m_rowOffsets.at(position) - row.height);
+    }
+    return changed;
+}
+
+void KeybindsLayer::releaseRowNode(size_t index) {
+    auto found = m_rowNodes.find(index);
+    if (found == m_rowNodes.end()) {
+        return;
+    }
+    auto node = found->second;
+    node->setVisible(false);
+    if (m_rows.at(index).action) {
+        auto bindable = static_cast<BindableNode*>(node);
+        m_rows.at(index).expanded = bindable->isExpanded();
+        m_freeNodes.push_back(bindable);
+    }
+    else {
+        m_freeHeaders.push_back(static_cast<FoldableLayer*>(node));
+    }
+    m_rowNodes.erase(found);
+}
+
+void KeybindsLayer::setRowFolded(size_t row, bool folded) {
+    m_rows.at(row).folded = folded;
+    this->layoutRows();
+}
+
+void KeybindsLayer::updateVisibility(std::unordered_set<CCNode*> const* dirty) {
+    if (m_virtualized) {
+        this->layoutRows();
+        return;
+    }
+    if (this->isRanking()) {
+        this->layoutResults();
+        return;
+    }
+    m_resultsContainer->setVisible(false);
     auto oldHeight = m_scroll->m_contentLayer->getContentSize().height;
     for (auto& container : m_containers) {
+        if (dirty && !dirty->contains(container)) {
+            continue;
+        }
         if (container != m_scroll->m_contentLayer && m_query.size()) {
             bool hasVisibleChildren = false;
             for (auto child : CCArrayExt<CCNode*>(container->getChildren())) {
@@ -688,6 +1093,24 @@ void KeybindsLayer::updateVisibility() {
     }
     m_scroll->scrollLayer(oldHeight - m_scroll->m_contentLayer->getContentSize().height);
 
+    this->updateResultsLabel();
+}
+
+void KeybindsLayer::updateResultsLabel() {
+    if (this->isRanking()) {
+        auto matches = m_searchIndex.getMatchCount();
+        m_resultsLabel->setString((matches > m_results.size() ?
+            fmt::format("Showing top {} of {} bindings", m_results.size(), matches) :
+            fmt::format("Showing {} bindings", matches)
+        ).c_str());
+        return;
+    }
+    if (m_builtNodes < m_pendingNodes.size()) {
+        m_resultsLabel->setString(fmt::format(
+            "Loading bindings... {}%", m_builtNodes * 100 / m_pendingNodes.size()
+        ).c_str());
+        return;
+    }
     size_t visible = 0;
     for (auto& node : m_nodes) {
         if (nodeIsVisible(node)) {
@@ -697,32 +1120,165 @@ void KeybindsLayer::updateVisibility() {
     m_resultsLabel->setString(fmt::format("Showing {} bindings", visible).c_str());
 }
 
+bool KeybindsLayer::isRanking() const {
+    return m_rankedSearch && m_query.size();
+}
+
+void KeybindsLayer::layoutResults() {
+    auto content = m_scroll->m_contentLayer;
+    auto width = m_scroll->getContentSize().width;
+    auto oldHeight = content->getContentSize().height;
+
+    // the result nodes are reused between searches
+    for (size_t i = 0; i < m_results.size(); i++) {
+        auto& action = m_searchIndex.getAction(m_results.at(i));
+        if (i < m_resultNodes.size()) {
+            m_resultNodes.at(i)->setAction(action, i % 2 == 0);
+        }
+        else {
+            auto node = BindableNode::create(this, action, width, i % 2 == 0);
+            m_resultsContainer->addChild(node);
+            m_resultNodes.push_back(node);
+        }
+        m_resultNodes.at(i)->setVisible(true);
+    }
+    for (size_t i = m_results.size(); i < m_resultNodes.size(); i++) {
+        m_resultNodes.at(i)->setVisible(false);
+    }
+
+    // the tree is laid out again once the search ends
+    for (auto child : CCArrayExt<CCNode*>(content->getChildren())) {
+        child->setVisible(child == m_resultsContainer);
+    }
+    m_resultsContainer->setContentSize(m_resultsContainer->getLayout()->getSizeHint(m_resultsContainer));
+    m_resultsContainer->updateLayout();
+
+    auto size = content->getLayout()->getSizeHint(content);
+    size.height = std::max(size.height, m_scroll->getContentSize().height);
+    content->setContentSize(size);
+    content->updateLayout();
+    m_scroll->scrollLayer(oldHeight - size.height);
+
+    this->updateResultsLabel();
+}
+
 void KeybindsLayer::updateAllBinds() {
+    if (m_virtualized) {
+        // the other rows get their binds when they come into view
+        for (auto& [index, node] : m_rowNodes) {
+            if (m_rows.at(index).action) {
+                static_cast<BindableNode*>(node)->updateMenu(false);
+            }
+        }
+        this->layoutRows();
+        return;
+    }
     for (auto& node : m_nodes) {
         node->updateMenu();
     }
+    // setting the results' actions again gets their new binds
+    if (this->isRanking()) {
+        this->layoutResults();
+    }
 }
 
 void KeybindsLayer::search(std::string const& query) {
+    bool wasSearching = m_query.size();
     m_query = query;
-    for (auto& node : m_nodes) {
+    m_capturing = false;
+    std::vector<size_t> changed;
+    auto key = m_capturedQuery.size() && query == m_capturedQuery ?
+        m_capturedKey : parseBindQuery(query);
+    if (key) {
+        // the actions come straight from BindManager's index of binds, so
+        // none of them have to be matched
+        std::vector<size_t> matching;
+        for (auto& action : BindManager::get()->getBindablesFor(key)) {
+            if (auto index = m_searchIndex.find(action.getID())) {
+                matching.push_back(*index);
+            }
+        }
+        changed = m_searchIndex.filter(std::move(matching));
+    }
+    else {
+        changed = m_searchIndex.search(query);
+    }
+    m_results = this->isRanking() ? m_searchIndex.rank(MAX_RANKED_RESULTS) : std::vector<size_t>();
+    if (m_virtualized) {
+        for (auto index : changed) {
+            m_rows.at(m_indexedRows.at(index)).matches = m_searchIndex.matches(index);
+        }
+        if (m_rankedSearch && (wasSearching || m_query.size())) {
+            // the rows in view get nodes again with the colors of their
+            // new places
+            while (m_rowNodes.size()) {
+                this->releaseRowNode(m_rowNodes.begin()->first);
+            }
+            this->layoutRows();
+        }
+        else if (changed.size() || wasSearching != !query.empty()) {
+            this->layoutRows();
+        }
+        return;
+    }
+    // only the containers of the nodes that changed are laid out again
+    std::unordered_set<CCNode*> dirty;
+    for (auto index : changed) {
+        // nodes that are still being built are shown once they all are
+        if (index >= m_nodes.size()) {
+            break;
+        }
+        auto node = m_nodes.at(index);
         if (
             node->getParent() == m_scroll->m_contentLayer ||
             !static_cast<FoldableLayer*>(node->getParent())->isFolded()
         ) {
-            node->setVisible(
-                !query.size() ||
-                fts::fuzzy_match_simple(query.c_str(), node->getMatchString().c_str())
-            );
+            node->setVisible(m_searchIndex.matches(index));
+            for (auto parent = node->getParent(); parent; parent = parent->getParent()) {
+                dirty.insert(parent);
+                if (parent == m_scroll->m_contentLayer) {
+                    break;
+                }
+            }
         }
     }
-    this->updateVisibility();
+    if (this->isRanking()) {
+        this->layoutResults();
+    }
+    // starting or ending a search shows or hides the categories without
+    // any actions too, so everything has to be laid out then
+    else if (wasSearching != !query.empty()) {
+        this->updateVisibility();
+    }
+    else if (dirty.size()) {
+        this->updateVisibility(&dirty);
+    }
 }
 
 void KeybindsLayer::textChanged(CCTextInputNode* input) {
     this->search(input->getString());
 }
 
+void KeybindsLayer::onCapture(CCObject*) {
+    this->deselectSearchInput();
+    m_capturing = true;
+    m_resultsLabel->setString("Press a bind to search for...");
+}
+
+ListenerResult KeybindsLayer::onCapturePressed(PressBindEvent* event) {
+    if (!m_capturing) {
+        return ListenerResult::Propagate;
+    }
+    if (event->isDown() && event->getBind()) {
+        auto query = "bind:" + event->getBind()->toString();
+        m_capturedQuery = query;
+        m_capturedKey = BindManager::get()->getKeyFor(event->getBind());
+        m_searchInput->setString(query);
+        this->search(query);
+    }
+    return ListenerResult::Stop;
+}
+
 void KeybindsLayer::onResetAll(CCObject*) {
     createQuickPopup(
         "Reset All",
@@ -730,9 +1286,7 @@ void KeybindsLayer::onResetAll(CCObject*) {
         "Cancel", "Reset",
         [=](auto*, bool btn2) {
             if (btn2) {
-                for (auto& action : BindManager::get()->getAllBindables()) {
-                    BindManager::get()->resetBindsToDefault(action.getID());
-                }
+                BindManager::get()->resetAllBindsToDefault();
                 this->updateAllBinds();
             }
         }
@@ -747,6 +1301,155 @@ void KeybindsLayer::onDevice(DeviceEvent*) {
     this->updateAllBinds();
 }
 
+static void appendLowercase(std::string& str, std::string const& add) {
+    for (auto c : add) {
+        str.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+}
+
+size_t KeybindsSearchIndex::add(BindableAction const& action) {
+    m_offsets.push_back(m_strings.size());
+    for (auto& str : {
+        action.getMod()->getName(),
+        action.getCategory().toString(),
+        action.getName(),
+        action.getDescription(),
+    }) {
+        appendLowercase(m_strings, str);
+        m_strings.push_back(' ');
+    }
+    m_strings.back() = '\0';
+    m_actions.push_back(action);
+    m_indices.insert({ action.getID(), m_offsets.size() - 1 });
+
+    auto index = m_matches.size();
+    m_matches.push_back(true);
+    m_matching.push_back(index);
+    return index;
+}
+
+std::vector<size_t> KeybindsSearchIndex::search(std::string const& query) {
+    std::string lowered;
+    appendLowercase(lowered, query);
+    if (lowered == m_query && !m_filtered) {
+        return {};
+    }
+    std::vector<size_t> changed;
+    // anything that matches the new query also matched the one it extends
+    if (lowered.starts_with(m_query) && !m_filtered) {
+        std::vector<size_t> matching;
+        for (auto index : m_matching) {
+            if (fts::fuzzy_match_simple(lowered.c_str(), m_strings.c_str() + m_offsets.at(index))) {
+                matching.push_back(index);
+            }
+            else {
+                m_matches.at(index) = false;
+                changed.push_back(index);
+            }
+        }
+        m_matching = std::move(matching);
+    }
+    else {
+        m_matching.clear();
+        for (size_t index = 0; index < m_offsets.size(); index++) {
+            bool matches = lowered.empty() ||
+                fts::fuzzy_match_simple(lowered.c_str(), m_strings.c_str() + m_offsets.at(index));
+            if (matches) {
+                m_matching.push_back(index);
+            }
+            if (matches != m_matches.at(index)) {
+                m_matches.at(index) = matches;
+                changed.push_back(index);
+            }
+        }
+    }
+    m_query = std::move(lowered);
+    m_filtered = false;
+    return changed;
+}
+
+std::vector<size_t> KeybindsSearchIndex::filter(std::vector<size_t> matching) {
+    std::sort(matching.begin(), matching.end());
+    matching.erase(std::unique(matching.begin(), matching.end()), matching.end());
+
+    std::vector<size_t> changed;
+    auto next = matching.begin();
+    for (size_t index = 0; index < m_matches.size(); index++) {
+        bool matches = next != matching.end() && *next == index;
+        if (matches) {
+            ++next;
+        }
+        if (matches != m_matches.at(index)) {
+            m_matches.at(index) = matches;
+            changed.push_back(index);
+        }
+    }
+    m_matching = std::move(matching);
+    m_query.clear();
+    m_filtered = true;
+    return changed;
+}
+
+std::vector<size_t> KeybindsSearchIndex::rank(size_t count) const {
+    if (!count) {
+        return {};
+    }
+    if (m_filtered) {
+        return std::vector<size_t>(
+            m_matching.begin(), m_matching.begin() + std::min(count, m_matching.size())
+        );
+    }
+    // a heap of the best matches so far with the worst on top, so it only
+    // ever holds `count` of them. Ties go to the action added first
+    using Match = std::pair<int, size_t>;
+    auto better = [](Match const& a, Match const& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    };
+    std::priority_queue<Match, std::vector<Match>, decltype(better)> best(better);
+    for (auto index : m_matching) {
+        int score = 0;
+        if (!fts::fuzzy_match(m_query.c_str(), m_strings.c_str() + m_offsets.at(index), score)) {
+            continue;
+        }
+        if (best.size() < count) {
+            best.push({ score, index });
+        }
+        else if (better({ score, index }, best.top())) {
+            best.pop();
+            best.push({ score, index });
+        }
+    }
+    std::vector<size_t> res(best.size());
+    for (auto it = res.rbegin(); it != res.rend(); it++) {
+        *it = best.top().second;
+        best.pop();
+    }
+    return res;
+}
+
+bool KeybindsSearchIndex::matches(size_t index) const {
+    return m_matches.at(index);
+}
+
+size_t KeybindsSearchIndex::getMatchCount() const {
+    return m_matching.size();
+}
+
+BindableAction const& KeybindsSearchIndex::getAction(size_t index) const {
+    return m_actions.at(index);
+}
+
+std::optional<size_t> KeybindsSearchIndex::find(ActionID const& action) const {
+    if (auto found = m_indices.find(action); found != m_indices.end()) {
+        return found->second;
+    }
+    return std::nullopt;
+}
+
+size_t KeybindsSearchIndex::size() const {
+    return m_offsets.size();
+}
+
 KeybindsLayer* KeybindsLayer::create() {
     auto ret = new KeybindsLayer;
     if (ret && ret->init(420.f, 280.f)) {
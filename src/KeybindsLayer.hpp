@@ -5,11 +5,15 @@
 #include <Geode/ui/InputNode.hpp>
 #include <Geode/binding/TextInputDelegate.hpp>
 #include "../include/Keybinds.hpp"
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace geode::prelude;
 using namespace keybinds;
 
 class KeybindsLayer;
+class FoldableLayer;
 
 class BindableNode : public CCNode {
 protected:
@@ -39,8 +43,13 @@ public:
         float width, bool bgColor
     );
 
+    /**
+     * Show a different action in this node, so the virtualized list can
+     * reuse it for another row
+     */
+    void setAction(BindableAction const& action, bool bgColor, bool expand = false);
     BindableAction const& getAction() const;
-    std::string getMatchString() const;
+    bool isExpanded() const;
     void updateMenu(bool updateLayer = true);
 };
 
@@ -78,27 +87,172 @@ public:
     static EditRepeatPopup* create(BindableNode* node);
 };
 
+/**
+ * A row of the virtualized keybinds list. The list is laid out from these,
+ * and only the rows in view get a node
+ */
+struct KeybindsRow {
+    static constexpr size_t NO_PARENT = static_cast<size_t>(-1);
+
+    // empty for category headers
+    std::optional<BindableAction> action;
+    // the last part of the category's path for headers
+    std::string title;
+    size_t depth = 0;
+    // the header this row is under
+    size_t parent = NO_PARENT;
+    // measured when the row first gets a node
+    float height = 0.f;
+    // the row's index in the rows being shown
+    size_t position = 0;
+    bool bgColor = false;
+    bool folded = false;
+    bool expanded = false;
+    // whether the action matches the search query
+    bool matches = true;
+    // whether any action under the header matches the search query
+    bool hasMatch = false;
+    bool shown = false;
+};
+
+/**
+ * The search strings of the actions in the keybinds menu. They're built once
+ * when the menu opens, and a query that extends the previous one is only
+ * tested against the actions that the previous one matched
+ */
+class KeybindsSearchIndex {
+protected:
+    // the lowercased, null-terminated strings of every action back to back
+    std::string m_strings;
+    std::vector<size_t> m_offsets;
+    std::vector<bool> m_matches;
+    std::vector<BindableAction> m_actions;
+    std::unordered_map<ActionID, size_t> m_indices;
+    // the indices of the actions matching the query in ascending order
+    std::vector<size_t> m_matching;
+    std::string m_query;
+    // whether the matches were set by filter rather than a query
+    bool m_filtered = false;
+
+public:
+    /**
+     * Add an action before anything has been searched. Actions are referred
+     * to by the order they were added in
+     */
+    size_t add(BindableAction const& action);
+    /**
+     * Match the actions against a new query, and get the ones that started
+     * or stopped matching in ascending order
+     */
+    std::vector<size_t> search(std::string const& query);
+    /**
+     * Set the matching actions directly, and get the ones that started or
+     * stopped matching in ascending order
+     */
+    std::vector<size_t> filter(std::vector<size_t> matching);
+    /**
+     * Score the actions matching the query, and get up to `count` of the
+     * best ones, best first. Filtered matches are kept in the order they
+     * were added in
+     */
+    std::vector<size_t> rank(size_t count) const;
+    bool matches(size_t index) const;
+    size_t getMatchCount() const;
+    BindableAction const& getAction(size_t index) const;
+    std::optional<size_t> find(ActionID const& action) const;
+    size_t size() const;
+};
+
+/**
+ * An item of the regular list that hasn't been built yet. Categories are
+ * items of their own so their containers are created in the same order as
+ * when the list is built all at once, even if they have no actions
+ */
+struct PendingKeybindsNode {
+    Category category;
+    std::optional<BindableAction> action;
+    bool bgColor = false;
+};
+
 class KeybindsLayer : public Popup<>, public TextInputDelegate {
 protected:
     ScrollLayer* m_scroll;
     std::vector<CCNode*> m_containers;
     std::vector<BindableNode*> m_nodes;
+    // the regular list is built a few items per frame after the first screenful
+    std::vector<PendingKeybindsNode> m_pendingNodes;
+    size_t m_builtNodes = 0;
+    bool m_virtualized = false;
+    std::vector<KeybindsRow> m_rows;
+    // the rows being shown and their distances from the top of the list
+    std::vector<size_t> m_shownRows;
+    std::vector<float> m_rowOffsets;
+    // the nodes of the rows in view by row index
+    std::unordered_map<size_t, CCNode*> m_rowNodes;
+    std::vector<BindableNode*> m_freeNodes;
+    std::vector<FoldableLayer*> m_freeHeaders;
+    float m_scrollY = 0.f;
+    KeybindsSearchIndex m_searchIndex;
+    // the row of every action in the search index for the virtualized list.
+    // The regular list's nodes are in the same order as the index
+    std::vector<size_t> m_indexedRows;
+    // a search shows the best matches in a flat list instead of the tree
+    bool m_rankedSearch = false;
+    std::vector<size_t> m_results;
+    // the container and nodes of the regular list's results
+    CCNode* m_resultsContainer = nullptr;
+    std::vector<BindableNode*> m_resultNodes;
     InputNode* m_searchInput;
     CCLabelBMFont* m_resultsLabel;
     std::string m_query;
+    // the next key pressed is searched for
+    bool m_capturing = false;
+    // binds of custom devices can't be parsed back from their names
+    std::string m_capturedQuery;
+    BindKey m_capturedKey;
+    EventListener<PressBindFilter> m_captureListener =
+        EventListener<PressBindFilter>(this, &KeybindsLayer::onCapturePressed);
     EventListener<DeviceFilter> m_deviceListener = 
         EventListener<DeviceFilter>(this, &KeybindsLayer::onDevice);
 
     bool setup() override;
+    void update(float dt) override;
     void textChanged(CCTextInputNode*) override;
     void onResetAll(CCObject*);
+    void onCapture(CCObject*);
+    ListenerResult onCapturePressed(PressBindEvent* event);
     void onDevice(DeviceEvent*);
 
+    void buildContainers();
+    /**
+     * Build the node of a pending item, and the containers of its category
+     * if they don't exist yet. Returns the height that was added to the list
+     */
+    float buildNode(PendingKeybindsNode const& pending, bool visible);
+    void buildPending(float);
+    void updateResultsLabel();
+    bool isRanking() const;
+    void layoutResults();
+    void buildRows();
+    void layoutRows();
+    /**
+     * Give the rows in view nodes, and take them from the rows that aren't.
+     * Returns true if any of the rows turned out to have a different height
+     * than they were laid out with
+     */
+    bool updateRowNodes();
+    void releaseRowNode(size_t row);
+
 public:
     static KeybindsLayer* create();
 
     void search(std::string const& query);
     void updateAllBinds();
-    void updateVisibility();
+    /**
+     * Lay out the list again. With the regular list, only the containers in
+     * `dirty` are laid out if it's given
+     */
+    void updateVisibility(std::unordered_set<CCNode*> const* dirty = nullptr);
+    void setRowFolded(size_t row, bool folded);
     void deselectSearchInput();
 };
@@ -35,10 +35,18 @@ static void addBindSprites(CCNode* target, const char* action) {
 }
 
 struct $modify(PauseLayer) {
+    struct Fields {
+        std::vector<Ref<ActionListener>> m_listeners;
+    };
+
+    void addActionListener(MiniFunction<ActionListener::Callback> callback, ActionID const& id) {
+        m_fields->m_listeners.push_back(ActionListener::create(id, callback));
+    }
+
     void customSetup() {
         PauseLayer::customSetup();
 
-        this->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             if (event->isDown()) {
                 this->onResume(nullptr);
                 return ListenerResult::Stop;
@@ -46,7 +54,7 @@ struct $modify(PauseLayer) {
             return ListenerResult::Propagate;
         }, "robtop.geometry-dash/unpause-level");
 
-        this->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             if (event->isDown()) {
                 this->onQuit(nullptr);
                 return ListenerResult::Stop;
@@ -54,7 +62,7 @@ struct $modify(PauseLayer) {
             return ListenerResult::Propagate;
         }, "robtop.geometry-dash/exit-level");
 
-        this->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             if (event->isDown()) {
                 if(PlayLayer::get() && PlayLayer::get()->m_isPracticeMode) {
                     this->onNormalMode(nullptr);
@@ -66,14 +74,14 @@ struct $modify(PauseLayer) {
             return ListenerResult::Propagate;
         }, "robtop.geometry-dash/practice-level");
 
-        this->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             if (event->isDown()) {
                 this->onRestart(nullptr);
                 return ListenerResult::Stop;
             }
             return ListenerResult::Propagate;
         }, "robtop.geometry-dash/restart-level");
-        this->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             if (event->isDown()) {
                 this->onRestartFull(nullptr);
                 return ListenerResult::Stop;
@@ -90,6 +98,14 @@ struct $modify(PauseLayer) {
 };
 
 struct $modify(UILayer) {
+    struct Fields {
+        std::vector<Ref<ActionListener>> m_listeners;
+    };
+
+    void addActionListener(MiniFunction<ActionListener::Callback> callback, ActionID const& id) {
+        m_fields->m_listeners.push_back(ActionListener::create(id, callback));
+    }
+
     static void onModify(auto& self) {
         (void)self.setHookPriority("UILayer::keyDown", 1000);
         (void)self.setHookPriority("UILayer::keyUp", 1000);
@@ -196,16 +212,14 @@ struct $modify(UILayer) {
     }
 
     void defineKeybind(const char* id, std::function<void(bool)> callback) {
-        // adding the events to playlayer instead
-        PlayLayer::get()->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             callback(event->isDown());
             return ListenerResult::Propagate;
         }, id);
     }
 
     void defineKeybindStop(const char* id, std::function<void(bool)> callback) {
-        // adding the events to playlayer instead
-        PlayLayer::get()->template addEventListener<InvokeBindFilter>([=](InvokeBindEvent* event) {
+        this->addActionListener([=](InvokeBindEvent* event) {
             callback(event->isDown());
             return ListenerResult::Stop;
         }, id);
@@ -226,123 +240,146 @@ struct $modify(UILayer) {
     }
 };
 
-$execute {
-    BindManager::get()->registerBindable({
+static constexpr BindableDescriptor PLAY_BINDABLES[] = {
+    {
         "robtop.geometry-dash/jump-p1",
         "Jump P1",
         "Player 1 Jump",
-        { 
-            Keybind::create(KEY_Space), 
-            Keybind::create(KEY_W),
-            ControllerBind::create(CONTROLLER_A),
-            ControllerBind::create(CONTROLLER_Up),
-            ControllerBind::create(CONTROLLER_RB) 
+        {
+            BindKey::keyboard(KEY_Space),
+            BindKey::keyboard(KEY_W),
+            BindKey::controller(CONTROLLER_A),
+            BindKey::controller(CONTROLLER_Up),
+            BindKey::controller(CONTROLLER_RB)
         },
-        Category::PLAY,
-        false
-    });
-    BindManager::get()->registerBindable({
+        Category::PLAY, false
+    },
+    {
         "robtop.geometry-dash/jump-p2",
         "Jump P2",
         "Player 2 Jump",
-        { Keybind::create(KEY_Up), ControllerBind::create(CONTROLLER_LB) },
-        Category::PLAY,
-        false
-    });
-    BindManager::get()->registerBindable({
+        {
+            BindKey::keyboard(KEY_Up),
+            BindKey::controller(CONTROLLER_LB)
+        },
+        Category::PLAY, false
+    },
+    {
         "robtop.geometry-dash/move-left-p1",
         "Move left P1",
         "Moves P1 left in platformer mode",
-        { Keybind::create(cocos2d::KEY_A), ControllerBind::create(CONTROLLER_Left), ControllerBind::create(CONTROLLER_LTHUMBSTICK_LEFT) },
-        Category::PLAY,
-        false 
-    });
-    BindManager::get()->registerBindable({
+        {
+            BindKey::keyboard(cocos2d::KEY_A),
+            BindKey::controller(CONTROLLER_Left),
+            BindKey::controller(CONTROLLER_LTHUMBSTICK_LEFT)
+        },
+        Category::PLAY, false
+    },
+    {
         "robtop.geometry-dash/move-right-p1",
         "Move right P1",
         "Moves P1 right in platformer mode",
-        { Keybind::create(cocos2d::KEY_D), ControllerBind::create(CONTROLLER_Right), ControllerBind::create(CONTROLLER_LTHUMBSTICK_RIGHT) },
-        Category::PLAY,
-        false 
-    });
-    BindManager::get()->registerBindable({
+        {
+            BindKey::keyboard(cocos2d::KEY_D),
+            BindKey::controller(CONTROLLER_Right),
+            BindKey::controller(CONTROLLER_LTHUMBSTICK_RIGHT)
+        },
+        Category::PLAY, false
+    },
+    {
         "robtop.geometry-dash/move-left-p2",
         "Move left P2",
         "Moves P2 left in platformer mode",
-        { Keybind::create(KEY_Left), ControllerBind::create(CONTROLLER_RTHUMBSTICK_LEFT) },
-        Category::PLAY,
-        false 
-    });
-    BindManager::get()->registerBindable({
+        {
+            BindKey::keyboard(KEY_Left),
+            BindKey::controller(CONTROLLER_RTHUMBSTICK_LEFT)
+        },
+        Category::PLAY, false
+    },
+    {
         "robtop.geometry-dash/move-right-p2",
         "Move right P2",
         "Moves P2 right in platformer mode",
-        { Keybind::create(KEY_Right), ControllerBind::create(CONTROLLER_RTHUMBSTICK_RIGHT) },
-        Category::PLAY,
-        false 
-    });
-    BindManager::get()->registerBindable({
+        {
+            BindKey::keyboard(KEY_Right),
+            BindKey::controller(CONTROLLER_RTHUMBSTICK_RIGHT)
+        },
+        Category::PLAY, false
+    },
+    {
         "robtop.geometry-dash/place-checkpoint",
         "Place Checkpoint",
         "Place a Checkpoint in Practice Mode",
-        { Keybind::create(KEY_Z, Modifier::None), ControllerBind::create(CONTROLLER_X) },
-        Category::PLAY, false 
-    });
-    BindManager::get()->registerBindable({
+        {
+            BindKey::keyboard(KEY_Z, Modifier::None),
+            BindKey::controller(CONTROLLER_X)
+        },
+        Category::PLAY, false
+    },
+    {
         "robtop.geometry-dash/delete-checkpoint",
         "Delete Checkpoint",
         "Delete a Checkpoint in Practice Mode",
-        { Keybind::create(KEY_X, Modifier::None), ControllerBind::create(CONTROLLER_B) },
+        {
+            BindKey::keyboard(KEY_X, Modifier::None),
+            BindKey::controller(CONTROLLER_B)
+        },
         Category::PLAY, false
-    });
-
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/pause-level",
         "Pause Level",
         "Pause the Level",
-        { ControllerBind::create(CONTROLLER_Start) },
+        { BindKey::controller(CONTROLLER_Start) },
         Category::PLAY, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/toggle-hitboxes",
         "Toggle hitboxes",
         "Toggles hitboxes while in practice mode",
-        { Keybind::create(KEY_P) },
+        { BindKey::keyboard(KEY_P) },
         Category::PLAY, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/restart-level",
         "Restart level",
         "Restarts the Level",
-        { Keybind::create(cocos2d::KEY_R, Modifier::None) },
+        { BindKey::keyboard(cocos2d::KEY_R, Modifier::None) },
         Category::PLAY, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/full-restart-level",
         "Full restart level",
         "Restarts the level from the beginning",
-        { Keybind::create(KEY_R, Modifier::Control) },
+        { BindKey::keyboard(KEY_R, Modifier::Control) },
         Category::PLAY, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/practice-level",
         "Toggle Practice",
         "Toggles Practice Mode",
-        { ControllerBind::create(CONTROLLER_X) },
+        { BindKey::controller(CONTROLLER_X) },
         Category::PLAY_PAUSE, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/unpause-level",
         "Unpause Level",
         "Unpause the Level",
-        { Keybind::create(KEY_Space, Modifier::None), ControllerBind::create(CONTROLLER_Start) },
+        {
+            BindKey::keyboard(KEY_Space, Modifier::None),
+            BindKey::controller(CONTROLLER_Start)
+        },
         Category::PLAY_PAUSE, false
-    });
-    BindManager::get()->registerBindable({
+    },
+    {
         "robtop.geometry-dash/exit-level",
         "Exit Level",
         "Exit the Level",
-        { ControllerBind::create(CONTROLLER_B) },
+        { BindKey::controller(CONTROLLER_B) },
         Category::PLAY_PAUSE, false
-    });
+    },
+};
+
+$execute {
+    BindManager::get()->registerBindables(PLAY_BINDABLES);
 }
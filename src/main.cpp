@@ -2,6 +2,7 @@
 #include <Geode/modify/MoreOptionsLayer.hpp>
 #include <Geode/binding/AppDelegate.hpp>
 #include <Geode/ui/Notification.hpp>
+#include <Geode/loader/SettingEvent.hpp>
 #include "../include/Keybinds.hpp"
 #include "Geode/modify/Modify.hpp"
 #include "KeybindsLayer.hpp"
@@ -10,7 +11,8 @@ using namespace geode::prelude;
 using namespace keybinds;
 
 class $modify(CCKeyboardDispatcher) {
-	static inline std::unordered_set<enumKeyCodes> s_held {};
+	// keyboard keys are Windows virtual-key codes, which all fit in a byte
+	static constexpr int KEYBOARD_KEY_COUNT = 0x100;
 
 	static void onModify(auto& self) {
 		(void)self.setHookPriority("cocos2d::CCKeyboardDispatcher::dispatchKeyboardMSG", 1000);
@@ -24,18 +26,23 @@ class $modify(CCKeyboardDispatcher) {
 	}
 
 	bool dispatchKeyboardMSG(enumKeyCodes key, bool down, bool p2) {
+		std::optional<Timestamp> timestamp;
+		if (BindManager::get()->isProfiling()) {
+			timestamp = std::chrono::steady_clock::now();
+		}
+		auto press = [&](BindKey bindKey) {
+			auto event = PressBindEvent(bindKey, down);
+			event.setTimestamp(timestamp);
+			return event.post();
+		};
 		if (keyIsController(key)) {
-			if (PressBindEvent(ControllerBind::create(key), down).post() == ListenerResult::Stop) {
+			BindManager::get()->setKeyHeld(key, down);
+			if (press(BindKey::controller(key)) == ListenerResult::Stop) {
 				return true;
 			}
 		} else {
 			if (!keyIsModifier(key)) {
-				if (down) {
-					s_held.insert(key);
-				}
-				else {
-					s_held.erase(key);
-				}
+				BindManager::get()->setKeyHeld(key, down);
 				Modifier modifiers = Modifier::None;
 				if (m_bControlPressed) {
 					modifiers |= Modifier::Control;
@@ -49,14 +56,15 @@ class $modify(CCKeyboardDispatcher) {
 				if (m_bShiftPressed) {
 					modifiers |= Modifier::Shift;
 				}
-				if (auto bind = Keybind::create(key, modifiers)) {
-					if (PressBindEvent(bind, down).post() == ListenerResult::Stop) {
+				if (key != KEY_None && key != KEY_Unknown) {
+					if (press(BindKey::keyboard(key, modifiers)) == ListenerResult::Stop) {
 						return true;
 					}
 				}
 			}
 			// dispatch release events for Modifier + Key combos
 			else {
+				BindManager::get()->setKeyHeld(key, down);
 				Modifier modifiers = Modifier::None;
 				if (m_bControlPressed || key == KEY_Control) {
 					modifiers |= Modifier::Control;
@@ -70,8 +78,18 @@ class $modify(CCKeyboardDispatcher) {
 				if (m_bShiftPressed || key == KEY_Shift) {
 					modifiers |= Modifier::Shift;
 				}
-				for (auto& held : s_held) {
-					if (PressBindEvent(Keybind::create(held, modifiers), down).post() == ListenerResult::Stop) {
+				// only held keys that have a bind with these modifiers can
+				// invoke anything, so the rest aren't posted at all
+				for (int code = 0; code < KEYBOARD_KEY_COUNT; code++) {
+					auto held = static_cast<enumKeyCodes>(code);
+					if (
+						keyIsModifier(held) ||
+						!BindManager::get()->isKeyHeld(held) ||
+						!BindManager::get()->isKeyBound(held, modifiers)
+					) {
+						continue;
+					}
+					if (press(BindKey::keyboard(held, modifiers)) == ListenerResult::Stop) {
 						// we want to pass modifiers onwards to the original
 						break;
 					}
@@ -127,3 +145,34 @@ $execute {
 		);
 	});
 }
+
+$execute {
+	BindManager::get()->setProfiling(Mod::get()->getSettingValue<bool>("profile-input-latency"));
+	listenForSettingChanges("profile-input-latency", +[](bool value) {
+		BindManager::get()->setProfiling(value);
+	});
+	BindManager::get()->setPostingAllInvokes(Mod::get()->getSettingValue<bool>("post-all-invoke-events"));
+	listenForSettingChanges("post-all-invoke-events", +[](bool value) {
+		BindManager::get()->setPostingAllInvokes(value);
+	});
+
+	BindManager::get()->registerBindable({
+		"dump-input-latency"_spr,
+		"Dump Input Latency",
+		"Write the input latencies measured with the \"Profile Input Latency\" "
+		"setting to input-latency.txt in the mod's save directory",
+		{}, Category::GLOBAL, false
+	});
+	static Ref<ActionListener> dumpListener = ActionListener::create("dump-input-latency"_spr, [](InvokeBindEvent* event) {
+		if (event->isDown()) {
+			auto path = Mod::get()->getSaveDir() / "input-latency.txt";
+			if (BindManager::get()->dumpLatencies(path)) {
+				Notification::create("Input latency dumped", NotificationIcon::Success)->show();
+			}
+			else {
+				Notification::create("Unable to dump input latency", NotificationIcon::Error)->show();
+			}
+		}
+		return ListenerResult::Propagate;
+	});
+}